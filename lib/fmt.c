@@ -0,0 +1,274 @@
+#include <string.h>
+#include "fmt.h"
+
+// "00" to "99": two decimal digits per division
+static const char digits2[200] =
+	"0001020304050607080910111213141516171819"
+	"2021222324252627282930313233343536373839"
+	"4041424344454647484950515253545556575859"
+	"6061626364656667686970717273747576777879"
+	"8081828384858687888990919293949596979899";
+
+static const char hex_lower[] = "0123456789abcdef";
+static const char hex_upper[] = "0123456789ABCDEF";
+
+/* Output buffer: chars are gathered here and sent to the sink by chunks */
+#define FMT_CHUNK	32
+
+typedef struct {
+	FmtSink		sink;
+	void		*ctx;
+	uint32_t	n;
+	int			total;
+	char		buf[FMT_CHUNK];
+} FmtOut;
+
+static void out_flush(FmtOut *o)
+{
+	if (o->n) {
+		o->sink(o->ctx, o->buf, o->n);
+		o->n = 0;
+	}
+}
+
+static void out_putc(FmtOut *o, char c)
+{
+	if (o->n == FMT_CHUNK) out_flush(o);
+	o->buf[o->n++] = c;
+	o->total++;
+}
+
+static void out_write(FmtOut *o, const char *s, uint32_t len)
+{
+	if (len > FMT_CHUNK - o->n) {	// long text: no copy
+		out_flush(o);
+		if (len >= FMT_CHUNK) {
+			o->sink(o->ctx, s, len);
+			o->total += (int)len;
+			return;
+		}
+	}
+	memcpy(o->buf + o->n, s, len);
+	o->n += len;
+	o->total += (int)len;
+}
+
+static void out_pad(FmtOut *o, char c, int n)
+{
+	while (n-- > 0) out_putc(o, c);
+}
+
+/*
+ * fmt_u32 : write v in base 10 backwards ending at 'end'
+ */
+char *fmt_u32(char *end, uint32_t v)
+{
+	while (v >= 100) {
+		uint32_t q = v / 100;
+		
+		end -= 2;
+		memcpy(end, &digits2[(v - q * 100) * 2], 2);
+		v = q;
+	}
+	if (v >= 10) {
+		end -= 2;
+		memcpy(end, &digits2[v * 2], 2);
+	} else {
+		*--end = (char)('0' + v);
+	}
+	return end;
+}
+
+// Write v in base 8 or 16 backwards ending at 'end' (pointers included)
+static char *fmt_pow2(char *end, uintptr_t v, unsigned shift, const char *digits)
+{
+	uintptr_t mask = ((uintptr_t)1 << shift) - 1;
+	
+	do {
+		*--end = digits[v & mask];
+		v >>= shift;
+	} while (v);
+	return end;
+}
+
+/*
+ * fmt_vformat : format fmt and ap, send the text to sink
+ */
+int fmt_vformat(FmtSink sink, void *ctx, const char *fmt, va_list ap)
+{
+	FmtOut o;
+	
+	o.sink = sink;
+	o.ctx = ctx;
+	o.n = 0;
+	o.total = 0;
+	
+	while (*fmt) {
+		const char *s = fmt;
+		char num[20], *q;			// "0x" and a 64-bit pointer (host)
+		const char *p, *end = num + sizeof(num);
+		char sign = 0, pad = ' ';
+		int left = 0, width = 0, prec = -1, lng = 0, len;
+		uint32_t u;
+		
+		// plain text up to the next conversion
+		while (*fmt && *fmt != '%') fmt++;
+		if (fmt != s) out_write(&o, s, (uint32_t)(fmt - s));
+		if (!*fmt) break;
+		fmt++;
+		
+		// flags, width, precision, length
+		for (;; fmt++) {
+			if (*fmt == '-') left = 1;
+			else if (*fmt == '0') pad = '0';
+			else if (*fmt == '+') sign = '+';
+			else if (*fmt == ' ') { if (!sign) sign = ' '; }
+			else break;
+		}
+		if (*fmt == '*') {
+			width = va_arg(ap, int);
+			if (width < 0) { left = 1; width = -width; }
+			fmt++;
+		} else {
+			while (*fmt >= '0' && *fmt <= '9') width = width * 10 + (*fmt++ - '0');
+		}
+		if (*fmt == '.') {
+			prec = 0;
+			fmt++;
+			while (*fmt >= '0' && *fmt <= '9') prec = prec * 10 + (*fmt++ - '0');
+		}
+		for (; *fmt == 'l' || *fmt == 'h'; fmt++) {
+			if (*fmt == 'l') lng = 1;
+		}
+		
+		switch (*fmt) {
+		case 'c':
+			num[0] = (char)va_arg(ap, int);
+			p = num;
+			end = num + 1;
+			sign = 0;
+			break;
+		case 's':
+			p = va_arg(ap, char *);
+			if (!p) p = "(null)";
+			len = 0;
+			while (p[len] && (prec < 0 || len < prec)) len++;
+			end = p + len;
+			sign = 0;
+			pad = ' ';
+			break;
+		case 'd':
+		case 'i': {
+			// read as passed (int or long), print on 32 bits
+			int32_t v = lng ? (int32_t)va_arg(ap, long) : (int32_t)va_arg(ap, int);
+			
+			if (v < 0) sign = '-';
+			p = fmt_u32(num + sizeof(num), v < 0 ? 0u - (uint32_t)v : (uint32_t)v);
+			break;
+		}
+		case 'u':
+		case 'x':
+		case 'X':
+		case 'o':
+			u = lng ? (uint32_t)va_arg(ap, unsigned long) : (uint32_t)va_arg(ap, unsigned);
+			if (*fmt == 'u') p = fmt_u32(num + sizeof(num), u);
+			else if (*fmt == 'o') p = fmt_pow2(num + sizeof(num), u, 3, hex_lower);
+			else p = fmt_pow2(num + sizeof(num), u, 4, *fmt == 'x' ? hex_lower : hex_upper);
+			sign = 0;
+			break;
+		case 'p':
+			q = fmt_pow2(num + sizeof(num), (uintptr_t)va_arg(ap, void *), 4, hex_lower);
+			*--q = 'x';
+			*--q = '0';
+			p = q;
+			sign = 0;
+			break;
+		case '\0':
+			fmt--;					// '%' at the end: print it
+			/* fall through */
+		case '%':
+			num[0] = '%';
+			p = num;
+			end = p + 1;
+			sign = 0;
+			pad = ' ';
+			width = 0;
+			break;
+		default:					// unknown: print it as is
+			p = fmt;
+			end = p + 1;
+			sign = 0;
+			break;
+		}
+		fmt++;
+		
+		// [spaces] [sign] [zeros] digits [spaces]
+		len = (int)(end - p) + (sign != 0);
+		if (!left && pad == ' ') out_pad(&o, ' ', width - len);
+		if (sign) out_putc(&o, sign);
+		if (!left && pad == '0') out_pad(&o, '0', width - len);
+		out_write(&o, p, (uint32_t)(end - p));
+		if (left) out_pad(&o, ' ', width - len);
+	}
+	out_flush(&o);
+	return o.total;
+}
+
+/*
+ * fmt_format : same as fmt_vformat with variable arguments
+ */
+int fmt_format(FmtSink sink, void *ctx, const char *fmt, ...)
+{
+	va_list ap;
+	int n;
+	
+	va_start(ap, fmt);
+	n = fmt_vformat(sink, ctx, fmt, ap);
+	va_end(ap);
+	return n;
+}
+
+/* fmt_vsnprintf sink: copy what fits */
+typedef struct {
+	char		*p;
+	uint32_t	left;				// room, '\0' excluded
+} FmtBuf;
+
+static void buf_sink(void *ctx, const char *s, uint32_t len)
+{
+	FmtBuf *b = ctx;
+	
+	if (len > b->left) len = b->left;
+	memcpy(b->p, s, len);
+	b->p += len;
+	b->left -= len;
+}
+
+/*
+ * fmt_vsnprintf : format into buf (size bytes, '\0' terminated)
+ */
+int fmt_vsnprintf(char *buf, uint32_t size, const char *fmt, va_list ap)
+{
+	FmtBuf b;
+	int n;
+	
+	b.p = buf;
+	b.left = size ? size - 1 : 0;
+	n = fmt_vformat(buf_sink, &b, fmt, ap);
+	if (size) *b.p = '\0';
+	return n;
+}
+
+/*
+ * fmt_snprintf : same as fmt_vsnprintf with variable arguments
+ */
+int fmt_snprintf(char *buf, uint32_t size, const char *fmt, ...)
+{
+	va_list ap;
+	int n;
+	
+	va_start(ap, fmt);
+	n = fmt_vsnprintf(buf, size, fmt, ap);
+	va_end(ap);
+	return n;
+}
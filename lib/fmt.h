@@ -0,0 +1,59 @@
+#ifndef _FMT_H_
+#define _FMT_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif 
+
+#include <stdint.h>
+#include <stdarg.h>
+
+/* Formatted output shared by uart_printf, term_printf and the LCD text.
+ *
+ * No heap and no static state: the text is built in a small buffer on
+ * the stack and handed to a sink a chunk at a time, so any number of
+ * callers can format at once. From an interrupt, only if the sink does
+ * not wait: fmt_snprintf, or uart_printf on a port set to UART_TX_DROP
+ * or UART_TX_REPORT (UART_TX_BLOCK, the default, waits for room).
+ *
+ * Conversions: %c %s %d %i %u %x %X %o %p %%, with the flags '-' (left
+ * justify), '0' (zero padding), '+' and ' ', a width (or '*') and, for
+ * %s, a precision. Arguments are read as int or unsigned, long or
+ * unsigned long with the 'l' modifier ('h' is accepted and ignored), and
+ * printed on 32 bits; %p prints the whole pointer.
+ */
+typedef void (*FmtSink)(void *ctx, const char *s, uint32_t len);
+
+/*
+ * fmt_vformat : format fmt and ap, send the text to sink; return the
+ *               number of chars sent
+ */
+int fmt_vformat(FmtSink sink, void *ctx, const char *fmt, va_list ap);
+
+/*
+ * fmt_format : same as fmt_vformat with variable arguments
+ */
+int fmt_format(FmtSink sink, void *ctx, const char *fmt, ...);
+
+/*
+ * fmt_vsnprintf : format into buf (size bytes, always '\0' terminated if
+ *                 size is not 0); return the length of the whole text,
+ *                 as snprintf
+ */
+int fmt_vsnprintf(char *buf, uint32_t size, const char *fmt, va_list ap);
+
+/*
+ * fmt_snprintf : same as fmt_vsnprintf with variable arguments
+ */
+int fmt_snprintf(char *buf, uint32_t size, const char *fmt, ...);
+
+/*
+ * fmt_u32 : write v in base 10 backwards ending at 'end', return a
+ *           pointer to the first digit (10 chars are enough)
+ */
+char *fmt_u32(char *end, uint32_t v);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,154 @@
+#include <string.h>
+#include "ring.h"
+
+/* Barriers between the producer and the consumer. The data must be
+ * written before the new 'wr' is seen, and read before the new 'rd' is
+ * seen: on the Cortex-M4 these are dmb instructions, which also stop the
+ * compiler from moving the buffer accesses across the index updates.
+ */
+#define RING_ACQUIRE()	__atomic_thread_fence(__ATOMIC_ACQUIRE)
+#define RING_RELEASE()	__atomic_thread_fence(__ATOMIC_RELEASE)
+
+/*
+ * ring_init : use the size bytes of buf (size is a power of 2), empty
+ */
+void ring_init(Ring *r, char *buf, uint32_t size)
+{
+	r->buf = buf;
+	r->mask = size - 1;
+	r->wr = 0;
+	r->rd = 0;
+}
+
+/*
+ * ring_count : number of bytes in the ring
+ */
+uint32_t ring_count(const Ring *r)
+{
+	return r->wr - r->rd;
+}
+
+/*
+ * ring_space : number of free bytes in the ring
+ */
+uint32_t ring_space(const Ring *r)
+{
+	return r->mask + 1 - (r->wr - r->rd);
+}
+
+/*
+ * ring_push : add a byte, return 0, or -1 if the ring is full
+ */
+int ring_push(Ring *r, char c)
+{
+	uint32_t wr = r->wr;
+	
+	if (wr - r->rd > r->mask) return -1;
+	RING_ACQUIRE();					// the consumer is done with the slot
+	r->buf[wr & r->mask] = c;
+	RING_RELEASE();
+	r->wr = wr + 1;
+	return 0;
+}
+
+/*
+ * ring_pop : remove a byte and return it, or -1 if the ring is empty
+ */
+int ring_pop(Ring *r)
+{
+	uint32_t rd = r->rd;
+	unsigned char c;
+	
+	if (r->wr == rd) return -1;
+	RING_ACQUIRE();					// the producer is done with the slot
+	c = (unsigned char)r->buf[rd & r->mask];
+	RING_RELEASE();
+	r->rd = rd + 1;
+	return c;
+}
+
+/*
+ * ring_write_span : first free byte and number of contiguous free bytes
+ */
+uint32_t ring_write_span(Ring *r, char **p)
+{
+	uint32_t wr = r->wr;
+	uint32_t space = r->mask + 1 - (wr - r->rd);
+	uint32_t end = r->mask + 1 - (wr & r->mask);	// bytes before wrapping
+	
+	RING_ACQUIRE();
+	*p = &r->buf[wr & r->mask];
+	return space < end ? space : end;
+}
+
+/*
+ * ring_write_commit : publish n bytes filled after ring_write_span
+ */
+void ring_write_commit(Ring *r, uint32_t n)
+{
+	RING_RELEASE();
+	r->wr += n;
+}
+
+/*
+ * ring_read_span : first byte and number of contiguous bytes
+ */
+uint32_t ring_read_span(Ring *r, const char **p)
+{
+	uint32_t rd = r->rd;
+	uint32_t count = r->wr - rd;
+	uint32_t end = r->mask + 1 - (rd & r->mask);	// bytes before wrapping
+	
+	RING_ACQUIRE();
+	*p = &r->buf[rd & r->mask];
+	return count < end ? count : end;
+}
+
+/*
+ * ring_read_commit : release n bytes read after ring_read_span
+ */
+void ring_read_commit(Ring *r, uint32_t n)
+{
+	RING_RELEASE();
+	r->rd += n;
+}
+
+/*
+ * ring_write : copy up to len bytes of buf in the ring (two spans at most)
+ */
+uint32_t ring_write(Ring *r, const char *buf, uint32_t len)
+{
+	uint32_t done = 0;
+	
+	while (done < len) {
+		char *p;
+		uint32_t n = ring_write_span(r, &p);
+		
+		if (n == 0) break;
+		if (n > len - done) n = len - done;
+		memcpy(p, buf + done, n);
+		ring_write_commit(r, n);
+		done += n;
+	}
+	return done;
+}
+
+/*
+ * ring_read : copy up to len bytes of the ring in buf (two spans at most)
+ */
+uint32_t ring_read(Ring *r, char *buf, uint32_t len)
+{
+	uint32_t done = 0;
+	
+	while (done < len) {
+		const char *p;
+		uint32_t n = ring_read_span(r, &p);
+		
+		if (n == 0) break;
+		if (n > len - done) n = len - done;
+		memcpy(buf + done, p, n);
+		ring_read_commit(r, n);
+		done += n;
+	}
+	return done;
+}
@@ -0,0 +1,84 @@
+#ifndef _RING_H_
+#define _RING_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif 
+
+#include <stdint.h>
+
+/* Single producer / single consumer byte ring.
+ *
+ * The producer (e.g. an interrupt handler) only writes 'wr', the consumer
+ * (e.g. the main loop) only writes 'rd', so no lock is needed. Both are
+ * free running counters: wr - rd is the number of bytes in the ring, and
+ * the size must be a power of 2 so that the index is counter & mask.
+ */
+typedef struct {
+	char				*buf;
+	uint32_t			mask;		// size - 1
+	volatile uint32_t	wr;			// bytes ever written, producer only
+	volatile uint32_t	rd;			// bytes ever read, consumer only
+} Ring;
+
+// Static initializer for a ring using the array 'buf' (power of 2 size)
+#define RING_INIT(buf)	{ (buf), sizeof(buf) - 1, 0, 0 }
+
+/*
+ * ring_init : use the size bytes of buf (size is a power of 2), empty
+ */
+void ring_init(Ring *r, char *buf, uint32_t size);
+
+/*
+ * ring_count : number of bytes in the ring
+ */
+uint32_t ring_count(const Ring *r);
+
+/*
+ * ring_space : number of free bytes in the ring
+ */
+uint32_t ring_space(const Ring *r);
+
+/*
+ * ring_push : (producer) add a byte, return 0, or -1 if the ring is full
+ */
+int ring_push(Ring *r, char c);
+
+/*
+ * ring_pop : (consumer) remove a byte and return it (0..255), or -1 if
+ *            the ring is empty
+ */
+int ring_pop(Ring *r);
+
+/*
+ * ring_write_span : (producer) set *p to the first free byte, return the
+ *                   number of contiguous free bytes there. Fill them,
+ *                   then publish n of them with ring_write_commit.
+ */
+uint32_t ring_write_span(Ring *r, char **p);
+void ring_write_commit(Ring *r, uint32_t n);
+
+/*
+ * ring_read_span : (consumer) set *p to the first byte, return the number
+ *                  of contiguous bytes there. Release n of them with
+ *                  ring_read_commit when done with them.
+ */
+uint32_t ring_read_span(Ring *r, const char **p);
+void ring_read_commit(Ring *r, uint32_t n);
+
+/*
+ * ring_write : (producer) copy up to len bytes of buf in the ring, return
+ *              the number of bytes copied
+ */
+uint32_t ring_write(Ring *r, const char *buf, uint32_t len);
+
+/*
+ * ring_read : (consumer) copy up to len bytes of the ring in buf, return
+ *             the number of bytes copied
+ */
+uint32_t ring_read(Ring *r, char *buf, uint32_t len);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -10,133 +10,73 @@
 
 #include "lib/term.h"
 #include "lib/uart.h"
+#include "lib/ring.h"
+#include "lib/fmt.h"
 
 
 // Local variables
 static USART_t *uart;
 static unsigned term_num_rows, term_num_cols;
-static unsigned term_cx, term_cy;
+static unsigned term_cx, term_cy;	// 0: unknown (term_flush)
 static unsigned fg_color;
+static unsigned term_sent;			// bytes sent
+
+// Screen model cell attribute: color (CL_BLACK..CL_WHITE as 1..8, 0 for
+// CL_DEFAULT) in bits 0..3, effect in bits 4..6
+#define ATTR(color, effect)		((uint8_t)(((color) ? (color) - CL_BLACK + 1 : 0) | (effect) << 4))
+#define ATTR_UNKNOWN			0xFF
+
+static uint8_t scr_attr = ATTR_UNKNOWN;	// attribute set on the terminal
 
 /****************************************************************************
  *  util functions
  ***************************************************************************/
-#define RING_BUF_SIZE	64
-
-typedef volatile struct RingBuffer {
-	char buf[RING_BUF_SIZE];
-	int  i_push;		/* pointeur (index) d'écriture */
-	int  i_pop;		/* pointeur (index) de lecture */
-} RingBuffer;
-
-static RingBuffer rx_buf = {
-	.i_push=0,
-	.i_pop=0
-};
+static char rx_data[64];
+static Ring rx_buf = RING_INIT(rx_data);	/* USART interrupt -> term_in */
 
 static void uart_cb(char c)
 {
-    // Si le buffer n'est pas plein
-    if ((rx_buf.i_push + 1) % RING_BUF_SIZE != rx_buf.i_pop) {
-        // Ecrire le caractère dans le buffer
-        rx_buf.buf[rx_buf.i_push] = c;
-        // Incrémenter l'index d'écriture
-        rx_buf.i_push = (rx_buf.i_push + 1) % RING_BUF_SIZE;
-    }
+	ring_push(&rx_buf, c);			// dropped if the buffer is full
 }
 
 // Terminal output function
 static void term_out(char c)
 {
 	uart_putc(uart, c);
+	term_sent++;
 }
 
 // Terminal input function
 static char term_in(void)
 {
-	unsigned char c;
-
-    // Attendre que le buffer ne soit plus vide
-    while (rx_buf.i_push == rx_buf.i_pop) {}
+	int c;
 
-    // Lire un caractère
-    c = rx_buf.buf[rx_buf.i_pop];
-    // Incrémenter l'index de lecture
-    rx_buf.i_pop = (rx_buf.i_pop + 1) % RING_BUF_SIZE;
+	// wait for a char
+	while ((c = ring_pop(&rx_buf)) < 0) {}
 
-	return c;
+	return (char)c;
 }
 
-// num2str
-//   convert a number 'number' in base 'base' to the string s (the string
-//   variable must be large enough)
-//   size : (unsigned int) minimal number of digit width for string number
-//   sp   : (boolean) complete the width with ' ' or '0'
-static void num2str(char *s, unsigned int number, unsigned int base, int size, int sp)
+// fmt sinks: raw output (escape sequences), and text that moves the cursor
+static void term_sink_raw(void *ctx, const char *s, uint32_t len)
 {
-	static char  hexChars[] = "0123456789ABCDEF";
-
-	char *p=s;
-	int cnt;
-	int i;
-	char tmp;
-
-	// get digits
-	do {
-		*s++=hexChars[number % base];
-	} while (number /= base);
-	*s='\0';
-
-	// reverse string
-	cnt=s-p;
-	for (i=0;i<cnt/2;i++) {
-		tmp=p[i]; p[i] = p[cnt-i-1]; p[cnt-i-1]=tmp;
-	}
-
-	// add extra space
-	if (cnt<size) {
-		for (i=cnt;i>=0;i--) p[i+size-cnt]=p[i];
-		if (sp) tmp=' '; else tmp='0';
-		for (i=0;i<size-cnt;i++) p[i]=tmp;
-	}
+	while (len--) term_out(*s++);
 }
 
-static unsigned int str2num(char *s, unsigned base)
+static void term_sink(void *ctx, const char *s, uint32_t len)
 {
-	unsigned int u=0, d;
-	char ch=*s++;
-	while (ch) {
-		if ((ch>='0') && (ch<='9')) d=ch-'0';
-		else if ((base==16) && (ch>='A') && (ch<='F')) d=ch-'A'+10;
-		else if ((base==16) && (ch>='a') && (ch<='f')) d=ch-'a'+10;
-		else break;
-		u=d+base*u;
-		ch=*s++;
-	}
-	return u;
+	while (len--) term_putc(*s++);
 }
 
 // Helper function: send the requested string to the terminal
 static void term_ansi( const char* fmt, ... )
 {
 	va_list ap;
-	char s[20], *p;
 	
 	term_out('\x1B');
 	term_out('[');
 	va_start(ap,fmt);
-	while (*fmt!='\0') {
-		if (*fmt=='%') {
-			switch (*++fmt) {
-			case 'u':
-				num2str(s, va_arg(ap, unsigned int), 10, 0, 0);
-				p=s;
-				while (*p) term_out(*p++);
-				break;
-			}
-		} else term_out(*fmt);
-		fmt++;
-	}
+	fmt_vformat(term_sink_raw, NULL, fmt, ap);
 	va_end(ap);
 }
 
@@ -144,10 +84,10 @@ static void term_ansi( const char* fmt, ... )
  *  terminal functions (public API)
  ***************************************************************************/
 // init function
-void term_init(USART_t *u, unsigned rows, unsigned cols)
+void term_init(USART_t *u, uint32_t baud, unsigned rows, unsigned cols)
 {
 	uart=u;
-	uart_init(uart, 115200, UART_8N1, uart_cb);
+	uart_init(uart, baud, UART_8N1, uart_cb);
 	term_num_rows = rows;
 	term_num_cols = cols;
 	term_cx = term_cy = 1;
@@ -177,6 +117,7 @@ void term_color(unsigned color, unsigned effect)
 	if (fg_color != color) {
 		term_ansi("%u;%um", effect, color);
 		fg_color = color;
+		scr_attr = effect ? ATTR_UNKNOWN : ATTR(color, 0);
 	}
 }
 
@@ -282,7 +223,7 @@ void term_putc( char ch )
 		if( term_cy < term_num_rows )
 			term_cy ++;
 		term_cx = 1;
-	} else term_cx++;
+	} else if( term_cx ) term_cx++;
 	term_out( ch );
 }
 
@@ -296,80 +237,10 @@ void term_puts( const char* str )
  
 void term_printf(const char* fmt, ...)
 {
-	va_list        ap;
-	char          *p;
-	char           ch;
-	unsigned long  ul;
-	unsigned long  size;
-	unsigned int   sp;
-	char           s[34];
+	va_list ap;
 	
 	va_start(ap, fmt);
-	while (*fmt != '\0') {
-		if (*fmt =='%') {
-			size=0; sp=1;
-			if (*++fmt=='0') {fmt++; sp=0;}	// parse %04d --> sp=0
-			ch=*fmt;
-			if ((ch>'0') && (ch<='9')) {	// parse %4d --> size=4
-				char tmp[10];
-				int i=0;
-				while ((ch>='0') && (ch<='9')) {
-					tmp[i++]=ch;
-					ch=*++fmt;
-				}
-				tmp[i]='\0';
-				size=str2num(tmp,10);
-			}
-			switch (ch) {
-				case '%':
-					term_putc('%');
-					break;
-				case 'c':
-					ch = (char)va_arg(ap, int);
-					term_putc(ch);
-					break;
-				case 's':
-					p = va_arg(ap, char *);
-					term_puts(p);
-					break;
-				case 'd':
-					ul = va_arg(ap, long);
-					if ((long)ul < 0) {
-						term_putc('-');
-						ul = -(long)ul;
-						size--;
-					}
-					num2str(s, ul, 10, size, sp);
-					term_puts(s);
-					break;
-				case 'u':
-					ul = va_arg(ap, unsigned int);
-					num2str(s, ul, 10, size, sp);
-					term_puts(s);
-					break;
-				case 'o':
-					ul = va_arg(ap, unsigned int);
-					num2str(s, ul, 8, size, sp);
-					term_puts(s);
-					break;
-				case 'p':
-					term_putc('0');
-					term_putc('x');
-					ul = va_arg(ap, unsigned int);
-					num2str(s, ul, 16, size, sp);
-					term_puts(s);
-					break;
-				case 'x':
-					ul = va_arg(ap, unsigned int);
-					num2str(s, ul, 16, size, sp);
-					term_puts(s);
-					break;
-				default:
-				    term_putc(*fmt);
-			}
-		} else term_putc(*fmt);
-		fmt++;
-	}
+	fmt_vformat(term_sink, NULL, fmt, ap);
 	va_end(ap);
 }
 
@@ -505,3 +376,170 @@ int term_readline (const char *prompt_str, char *buf, int maxlength)
 	}
 	return len;
 }
+
+
+//-----------------------------
+//  screen model
+//-----------------------------
+
+typedef struct {
+	char	ch;
+	uint8_t	attr;
+} TermCell;
+
+typedef struct {
+	unsigned x, y;
+} TermPos;
+
+static TermCell scr_want[TERM_SCREEN_ROWS][TERM_SCREEN_COLS];	// drawn
+static TermCell scr_shown[TERM_SCREEN_ROWS][TERM_SCREEN_COLS];	// on the terminal
+static unsigned scr_rows, scr_cols;
+static uint8_t scr_pen;				// attribute of the text drawn
+
+static void scr_fill(TermCell cells[TERM_SCREEN_ROWS][TERM_SCREEN_COLS])
+{
+	for (unsigned y = 0; y < TERM_SCREEN_ROWS; ++y) {
+		for (unsigned x = 0; x < TERM_SCREEN_COLS; ++x) {
+			cells[y][x] = (TermCell){ ' ', 0 };
+		}
+	}
+}
+
+static unsigned digits(unsigned n)
+{
+	unsigned d = 1;
+	while (n >= 10) { n /= 10; d++; }
+	return d;
+}
+
+// Move the cursor to (x, y), the cheapest way from where it is
+static void scr_move(unsigned x, unsigned y)
+{
+	unsigned cx = term_cx, cy = term_cy;
+	unsigned n, i;
+
+	if (cx && cy == y) {
+		if (x == cx) return;
+		if (x > cx) {
+			n = x - cx;
+			// the cells in between are up to date: writing them again
+			// moves the cursor as well, if they have the current color
+			for (i = cx; i < x && scr_shown[y-1][i-1].attr == scr_attr; ++i) {}
+			if (i == x && n <= (n == 1 ? 3 : 3 + digits(n))) {
+				for (i = cx; i < x; ++i) term_out(scr_shown[y-1][i-1].ch);
+			} else if (n == 1) {
+				term_ansi("C");
+			} else {
+				term_ansi("%uC", n);
+			}
+		} else if (x == 1) {
+			term_out('\r');
+		} else if ((n = cx - x) == 1) {
+			term_ansi("D");
+		} else {
+			term_ansi("%uD", n);
+		}
+	} else if (cx && y == cy + 1 && x == 1) {
+		term_out('\r');
+		term_out('\n');
+	} else if (cx && x == cx) {
+		n = y > cy ? y - cy : cy - y;
+		if (n == 1) term_ansi(y > cy ? "B" : "A");
+		else term_ansi(y > cy ? "%uB" : "%uA", n);
+	} else if (x == 1) {
+		term_ansi("%uH", y);
+	} else {
+		term_ansi("%u;%uH", y, x);
+	}
+	term_cx = x;
+	term_cy = y;
+}
+
+// Set the color and effect of attribute attr, the others reset
+static void scr_sgr(uint8_t attr)
+{
+	unsigned color = (attr & 0x0F) ? (attr & 0x0F) + CL_BLACK - 1 : CL_DEFAULT;
+	unsigned effect = attr >> 4;
+
+	if (color && effect) term_ansi("0;%u;%um", effect, color);
+	else if (color) term_ansi("0;%um", color);
+	else if (effect) term_ansi("0;%um", effect);
+	else term_ansi("0m");
+	scr_attr = attr;
+	fg_color = color;
+}
+
+static void scr_put(TermPos *p, char c)
+{
+	if (p->y < 1 || p->y > scr_rows || p->x < 1 || p->x > scr_cols) return;
+	scr_want[p->y-1][p->x-1] = (TermCell){ (c < ' ' || c > '~') ? ' ' : c, scr_pen };
+	p->x++;
+}
+
+static void term_sink_screen(void *ctx, const char *s, uint32_t len)
+{
+	while (len--) scr_put(ctx, *s++);
+}
+
+// Clear the terminal and the model, as large as the terminal if it fits
+void term_screen_init(void)
+{
+	scr_rows = term_num_rows < TERM_SCREEN_ROWS ? term_num_rows : TERM_SCREEN_ROWS;
+	scr_cols = term_num_cols < TERM_SCREEN_COLS ? term_num_cols : TERM_SCREEN_COLS;
+	scr_sgr(0);
+	term_clrscr();
+	scr_fill(scr_want);
+	scr_fill(scr_shown);
+	scr_pen = 0;
+}
+
+// Clear the model, the terminal is cleared by the next flush
+void term_screen_clear(void)
+{
+	scr_fill(scr_want);
+}
+
+// Color of the text written to the model from now on
+void term_screen_color(unsigned color, unsigned effect)
+{
+	scr_pen = ATTR(color, effect);
+}
+
+// Write str at (x, y) in the model, clipped to the screen
+void term_screen_puts(unsigned x, unsigned y, const char *str)
+{
+	TermPos p = { x, y };
+
+	while (*str) scr_put(&p, *str++);
+}
+
+void term_screen_printf(unsigned x, unsigned y, const char *fmt, ...)
+{
+	TermPos p = { x, y };
+	va_list ap;
+
+	va_start(ap, fmt);
+	fmt_vformat(term_sink_screen, &p, fmt, ap);
+	va_end(ap);
+}
+
+// Send the cells that differ from the terminal, row by row
+unsigned term_flush(void)
+{
+	unsigned sent = term_sent;
+
+	for (unsigned y = 0; y < scr_rows; ++y) {
+		for (unsigned x = 0; x < scr_cols; ++x) {
+			TermCell *w = &scr_want[y][x], *s = &scr_shown[y][x];
+
+			if (w->ch == s->ch && w->attr == s->attr) continue;
+			scr_move(x + 1, y + 1);
+			if (w->attr != scr_attr) scr_sgr(w->attr);
+			term_out(w->ch);
+			*s = *w;
+			// past the last column, where the cursor is depends on the terminal
+			term_cx = x + 1 < term_num_cols ? x + 2 : 0;
+		}
+	}
+	return term_sent - sent;
+}
@@ -95,8 +95,8 @@ enum
 // ****************************************************************************
 // Exported functions
 
-// Terminal initialization
-void term_init(USART_t *u, unsigned int rows, unsigned int cols);
+// Terminal initialization, at baud bauds 8N1
+void term_init(USART_t *u, uint32_t baud, unsigned int rows, unsigned int cols);
 
 // Terminal output functions
 void term_clrscr(void);
@@ -122,6 +122,25 @@ void term_printf(const char* fmt, ...);
 
 int term_readline(const char *prompt_str, char *buf, int maxlength);
 
+// Screen model: text is written to a copy of the screen, term_flush()
+// sends the terminal what changed since the previous flush, with the
+// shortest cursor moves and color changes it can. Coordinates start at 1
+// like term_gotoxy(), the model is TERM_SCREEN_ROWS x TERM_SCREEN_COLS at
+// most.
+#ifndef TERM_SCREEN_ROWS
+#define TERM_SCREEN_ROWS			24
+#endif
+#ifndef TERM_SCREEN_COLS
+#define TERM_SCREEN_COLS			80
+#endif
+
+void term_screen_init(void);		// clear the terminal and the model
+void term_screen_clear(void);		// clear the model only
+void term_screen_color(unsigned int color, unsigned int effect);
+void term_screen_puts(unsigned int x, unsigned int y, const char *str);
+void term_screen_printf(unsigned int x, unsigned int y, const char *fmt, ...);
+unsigned int term_flush(void);		// return the number of bytes sent
+
 #ifdef __cplusplus
 }
 #endif
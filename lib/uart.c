@@ -2,18 +2,95 @@
 #include <stdarg.h>
 #include "uart.h"
 #include "io.h"
+#include "dma.h"
 #include "util.h"
+#include "ring.h"
+#include "fmt.h"
+
+/* DMA receive state, see uart_rx_dma() */
+typedef struct {
+	DMA_t			*dma;
+	uint32_t		stream;
+	int				channel;
+	IRQn_t			irq;
+	DMA_Stream_t	*s;				// NULL when receiving by interrupt
+	char			*buf;
+	uint32_t		size;
+	uint32_t		rd;				// next byte to hand to the consumer
+	OnUartRxSpan	cb;
+} UartDmaRx;
+
+static void uart_rx_flush(UartDmaRx *rx);
+
+/* Interrupt driven transmit ring, see uart_putc() */
+typedef struct {
+	Ring				ring;		// uart_putc -> TXE interrupt
+	char				buf[UART_TX_RING];
+	int					policy;
+	UartTxStats			stats;
+} UartTxRing;
+
+#ifdef USE_USART1
+static UartTxRing usart1_txr = { .ring = RING_INIT(usart1_txr.buf) };
+#endif
+#ifdef USE_USART2
+static UartTxRing usart2_txr = { .ring = RING_INIT(usart2_txr.buf) };
+#endif
+#ifdef USE_USART6
+static UartTxRing usart6_txr = { .ring = RING_INIT(usart6_txr.buf) };
+#endif
+
+// TXE interrupt: send the next byte of the ring, or stop when empty
+static void uart_tx_irq(USART_t *u, UartTxRing *r)
+{
+	int c = ring_pop(&r->ring);
+	
+	if (c >= 0) {
+		u->DR = (uint32_t)c;
+	} else {
+		u->CR1 &= ~(1<<7);			// TXEIE
+	}
+}
+
+#ifdef USE_USART1
+static UartDmaRx usart1_rx = { .dma=_DMA2, .stream=2, .channel=4, .irq=USART1_IRQn };
+#endif
+#ifdef USE_USART2
+static UartDmaRx usart2_rx = { .dma=_DMA1, .stream=5, .channel=4, .irq=USART2_IRQn };
+#endif
+#ifdef USE_USART6
+static UartDmaRx usart6_rx = { .dma=_DMA2, .stream=1, .channel=5, .irq=USART6_IRQn };
+#endif
                              
 #ifdef USE_USART1
 static OnUartRx usart1_cb=0;
+static uint32_t usart1_overruns=0;
 
 void USART1_IRQHandler(void)
 {
 	uint32_t sr = _USART1->SR;
+
+	// Overrun: a byte arrived before DR was read. Every path below reads
+	// DR after SR (or lets the DMA do it), which clears ORE: one count
+	// per event.
+	if (sr & (1<<3)) usart1_overruns++;
+
+	if ((sr & (1<<7)) && (_USART1->CR1 & (1<<7))) {	// transmit data register empty
+		uart_tx_irq(_USART1, &usart1_txr);
+	}
+
+	if (usart1_rx.s) {			// DMA receive: DR belongs to the DMA
+		// clear the idle flag, or an overrun (EIE) with nothing left in DR;
+		// when DR is full, the DMA reads it next and clears ORE
+		if ((sr & ((1<<4)|(1<<3))) && !(sr & (1<<5))) _USART1->DR;
+		uart_rx_flush(&usart1_rx);
+		return;
+	}
 	
 	if (sr & (1<<5)) {			// Read data register not empty interrupt
 		if (!((sr & (1<<2)) || (sr & (1<<2)))) {
-			if (usart1_cb) usart1_cb((char)_USART1->DR);
+			char c = (char)_USART1->DR;
+			if (usart1_cb) usart1_cb(c);
 		} else {				// Noise or framing error or break detected
 			_USART1->DR;
 		}
@@ -29,14 +106,33 @@ void USART1_IRQHandler(void)
 
 #ifdef USE_USART2
 static OnUartRx usart2_cb=0;
+static uint32_t usart2_overruns=0;
 
 void USART2_IRQHandler(void)
 {
 	uint32_t sr = _USART2->SR;
 
+	// Overrun: a byte arrived before DR was read. Every path below reads
+	// DR after SR (or lets the DMA do it), which clears ORE: one count
+	// per event.
+	if (sr & (1<<3)) usart2_overruns++;
+
+	if ((sr & (1<<7)) && (_USART2->CR1 & (1<<7))) {	// transmit data register empty
+		uart_tx_irq(_USART2, &usart2_txr);
+	}
+
+	if (usart2_rx.s) {			// DMA receive: DR belongs to the DMA
+		// clear the idle flag, or an overrun (EIE) with nothing left in DR;
+		// when DR is full, the DMA reads it next and clears ORE
+		if ((sr & ((1<<4)|(1<<3))) && !(sr & (1<<5))) _USART2->DR;
+		uart_rx_flush(&usart2_rx);
+		return;
+	}
+
 	if (sr & (1<<5)) {			// Read data register not empty interrupt
 		if (!((sr & (1<<2)) || (sr & (1<<2)))) {
-			if (usart2_cb) usart2_cb((char)_USART2->DR);
+			char c = (char)_USART2->DR;
+			if (usart2_cb) usart2_cb(c);
 		} else {				// Noise or framing error or break detected
 			_USART2->DR;
 		}
@@ -52,14 +148,33 @@ void USART2_IRQHandler(void)
 
 #ifdef USE_USART6
 static OnUartRx usart6_cb=0;
+static uint32_t usart6_overruns=0;
 
 void USART6_IRQHandler(void)
 {
 	uint32_t sr = _USART6->SR;
+
+	// Overrun: a byte arrived before DR was read. Every path below reads
+	// DR after SR (or lets the DMA do it), which clears ORE: one count
+	// per event.
+	if (sr & (1<<3)) usart6_overruns++;
+
+	if ((sr & (1<<7)) && (_USART6->CR1 & (1<<7))) {	// transmit data register empty
+		uart_tx_irq(_USART6, &usart6_txr);
+	}
+
+	if (usart6_rx.s) {			// DMA receive: DR belongs to the DMA
+		// clear the idle flag, or an overrun (EIE) with nothing left in DR;
+		// when DR is full, the DMA reads it next and clears ORE
+		if ((sr & ((1<<4)|(1<<3))) && !(sr & (1<<5))) _USART6->DR;
+		uart_rx_flush(&usart6_rx);
+		return;
+	}
 	
 	if (sr & (1<<5)) {			// Read data register not empty interrupt
 		if (!((sr & (1<<2)) || (sr & (1<<2)))) {
-			if (usart6_cb) usart6_cb((char)_USART6->DR);
+			char c = (char)_USART6->DR;
+			if (usart6_cb) usart6_cb(c);
 		} else {				// Noise or framing error or break detected
 			_USART6->DR;
 		}
@@ -74,12 +189,55 @@ void USART6_IRQHandler(void)
 #endif
 
 /*
- * uart_init : polling Tx and IRQ Rx
+ * uart_brr : BRR value for baud from clock pclk, 8x oversampling flag
+ *            and baud rate error in ppm; 0 if out of range
+ */
+static uint32_t uart_brr(uint32_t pclk, uint32_t baud, uint32_t *over8, int32_t *error)
+{
+	uint32_t div;
+	
+	if (baud == 0) return 0;
+	
+	// baud = pclk / (8 * (2 - OVER8) * USARTDIV): div is USARTDIV in 1/16
+	// (16x oversampling) or in 1/8 (8x), rounded to the nearest
+	div = (pclk + baud / 2) / baud;
+	if (div < 8) return 0;			// over fPCLK/8
+	if (div > 0xFFFF) return 0;		// under fPCLK/65535: BRR is 16-bit
+	
+	*error = (int32_t)(((int64_t)pclk * 1000000) / ((int64_t)div * baud) - 1000000);
+	if (div >= 16) {				// 16x: better noise immunity
+		*over8 = 0;
+		return div;
+	}
+	// 8x: mantissa in bits 4-15, fraction in bits 0-2
+	*over8 = 1;
+	return ((div >> 3) << 4) | (div & 7);
+}
+
+static uint32_t uart_pclk(USART_t *u)
+{
+	return u == _USART2 ? sysclks.apb1_freq : sysclks.apb2_freq;
+}
+
+#ifdef USE_USART1
+static int32_t usart1_baud_error = 0;
+#endif
+#ifdef USE_USART2
+static int32_t usart2_baud_error = 0;
+#endif
+#ifdef USE_USART6
+static int32_t usart6_baud_error = 0;
+#endif
+
+/*
+ * uart_init : interrupt driven Tx ring and IRQ Rx
  */
 int uart_init(USART_t *u, uint32_t baud, uint32_t mode, OnUartRx cb)
 {
 	IRQn_t	irq_number;
 	uint32_t irq_priority;
+	int32_t *baud_error;
+	uint32_t brr, over8;
 	
 	if (u == _USART1) {
 #ifdef USE_USART1
@@ -87,8 +245,11 @@ int uart_init(USART_t *u, uint32_t baud, uint32_t mode, OnUartRx cb)
 		 _RCC->APB2ENR |= (1<<4);
 		// configure Tx/Rx pins : Tx -->, Rx --> 
 		io_configure(USART1_GPIO_PORT, USART1_GPIO_PINS, USART1_GPIO_CFG, NULL);
-		// configure USART speed
-		u->BRR = sysclks.apb2_freq/baud;
+
+		usart1_cb=cb;
+		irq_number=37;
+		irq_priority=3;
+		baud_error=&usart1_baud_error;
 #else
 		return -1;
 #endif
@@ -103,8 +264,7 @@ int uart_init(USART_t *u, uint32_t baud, uint32_t mode, OnUartRx cb)
 		usart2_cb=cb;
 		irq_number=38;
 		irq_priority=3;
-		// configure USART speed
-		u->BRR = sysclks.apb1_freq/baud;
+		baud_error=&usart2_baud_error;
 #else
 		return -1;
 #endif
@@ -118,9 +278,7 @@ int uart_init(USART_t *u, uint32_t baud, uint32_t mode, OnUartRx cb)
 		usart6_cb=cb;
 		irq_number=71;
 		irq_priority=3;
-
-		// configure USART speed
-		u->BRR = sysclks.apb2_freq/baud;
+		baud_error=&usart6_baud_error;
 #else
 		return -1;
 #endif
@@ -128,21 +286,43 @@ int uart_init(USART_t *u, uint32_t baud, uint32_t mode, OnUartRx cb)
 		return -1;
 	}
 	
+	// configure USART speed
+	brr = uart_brr(uart_pclk(u), baud, &over8, baud_error);
+	if (brr == 0 || *baud_error > UART_BAUD_MAX_ERROR || *baud_error < -UART_BAUD_MAX_ERROR) {
+		return -1;
+	}
+	u->BRR = brr;
+	
 	u->GTPR = 0;
 	u->CR3 = 0;
 	u->CR2 = UART_STOP_1;
-	u->CR1 = (UART_CHAR_8 | UART_PAR_NO | (1<<13) | (1<<2) | (1<<3) | (1<<5)) ;
+	u->CR1 = (UART_CHAR_8 | UART_PAR_NO | (over8<<15) | (1<<13) | (1<<2) | (1<<3) | (cb ? (1<<5) : 0)) ;
 			 
-	// Setup NVIC
-	if (cb) {
-		// configure NVIC
-		NVIC_SetPriority(irq_number, irq_priority ); //voir include/cmsis/core_cm4.h & include/config.h
-	    NVIC_EnableIRQ(irq_number);
-	}
+	// Setup NVIC: Rx callback and Tx ring
+	NVIC_SetPriority(irq_number, irq_priority ); //voir include/cmsis/core_cm4.h & include/config.h
+	NVIC_EnableIRQ(irq_number);
 	
     return 1;
 }
 
+/*
+ * uart_overruns : number of overrun events (ORE): one or more received
+ *                 bytes lost each
+ */
+uint32_t uart_overruns(USART_t *u)
+{
+#ifdef USE_USART1
+	if (u == _USART1) return usart1_overruns;
+#endif
+#ifdef USE_USART2
+	if (u == _USART2) return usart2_overruns;
+#endif
+#ifdef USE_USART6
+	if (u == _USART6) return usart6_overruns;
+#endif
+	return 0;
+}
+
 /*
  * uart_getc : get a char from the serial link (blocking)
  */
@@ -166,70 +346,346 @@ int uart_getchar(USART_t *u, char *c)
 	return 0;
 }
 
+static UartTxRing *uart_tx_ring(USART_t *u)
+{
+#ifdef USE_USART1
+	if (u == _USART1) return &usart1_txr;
+#endif
+#ifdef USE_USART2
+	if (u == _USART2) return &usart2_txr;
+#endif
+#ifdef USE_USART6
+	if (u == _USART6) return &usart6_txr;
+#endif
+	return NULL;
+}
+
+/*
+ * uart_baud_error : error of the baud rate set by uart_init, in ppm
+ */
+int32_t uart_baud_error(USART_t *u)
+{
+#ifdef USE_USART1
+	if (u == _USART1) return usart1_baud_error;
+#endif
+#ifdef USE_USART2
+	if (u == _USART2) return usart2_baud_error;
+#endif
+#ifdef USE_USART6
+	if (u == _USART6) return usart6_baud_error;
+#endif
+	return 0;
+}
+
+/*
+ * uart_baud_max : fastest profile the port can run at
+ */
+uint32_t uart_baud_max(USART_t *u, int32_t max_error)
+{
+	static const uint32_t profiles[] = UART_BAUD_PROFILES;
+	uint32_t best = 0, over8;
+	int32_t error;
+	
+	for (unsigned i = 0; i < sizeof(profiles) / sizeof(profiles[0]); i++) {
+		if (uart_brr(uart_pclk(u), profiles[i], &over8, &error) &&
+			error <= max_error && error >= -max_error) {
+			best = profiles[i];
+		}
+	}
+	return best;
+}
+
 /*
- * uart_putc : send a char over the serial link (polling)
+ * uart_tx_policy : what uart_putc does when the transmit ring is full
  */
-void uart_putc(USART_t *u, char c)
+void uart_tx_policy(USART_t *u, int policy)
 {
-	// wait for Data Register empty
-	while((u->SR & (1<<7)) == 0){}
-	// write char to send
-	u->DR = c;										
+	UartTxRing *r = uart_tx_ring(u);
+	
+	if (r) r->policy = policy;
+}
+
+/*
+ * uart_tx_stats : transmit ring statistics
+ */
+const UartTxStats *uart_tx_stats(USART_t *u)
+{
+	UartTxRing *r = uart_tx_ring(u);
+	
+	return r ? &r->stats : NULL;
 }
 
 /*
- * uart_puts : send a string over the serial link (polling)
+ * uart_putc : queue a char in the transmit ring (TXE interrupt)
  */
-void uart_puts(USART_t *u, const char *s)
+int uart_putc(USART_t *u, char c)
 {
-	while(*s){
-		// wait for Data Register empty
-		while((u->SR & (1<<7)) == 0){}
-		// send a char
-		u->DR = *s++;
+	UartTxRing *r = uart_tx_ring(u);
+	uint32_t level;
+	
+	if (!r) return -1;
+	
+	while (ring_push(&r->ring, c) < 0) {
+		if (r->policy == UART_TX_BLOCK) continue;	// the interrupt makes room
+		if (r->policy == UART_TX_DROP) r->stats.dropped++;
+		return -1;
 	}
 	
+	level = ring_count(&r->ring);
+	if (level > r->stats.high_water) r->stats.high_water = level;
+	
+	u->CR1 |= (1<<7);				// TXEIE: the interrupt sends it
+	return 0;
 }
 
 /*
- * uart_printf : print formatted text to serial link
+ * uart_puts : queue a string in the transmit ring
+ */
+int uart_puts(USART_t *u, const char *s)
+{
+	int n = 0;
+	
+	while (*s) {
+		if (uart_putc(u, *s++) < 0) break;
+		n++;
+	}
+	return n;
+}
+
+/* uart_printf sink: queue the text in the transmit ring */
+static void uart_sink(void *ctx, const char *s, uint32_t len)
+{
+	while (len--) uart_putc((USART_t *)ctx, *s++);
+}
+
+/*
+ * uart_printf : print formatted text to serial link (see lib/fmt.h)
  */
 void uart_printf(USART_t * u, const char* fmt, ...)
 {
-	va_list        ap;
-	char          *p;
-	char           ch;
-	unsigned long  ul;
-	char           s[34];
+	va_list ap;
 	
 	va_start(ap, fmt);
-	while (*fmt != '\0') {
-		if (*fmt =='%') {
-			switch (*++fmt) {
-				case '%':
-					uart_putc(u,'%');
-					break;
-				case 'c':
-					ch = (char)va_arg(ap, int);
-					/* A COM    PLETER */
-					break;
-				case 's':
-					/* A COMPLETER */
-					break;
-				case 'd':
-					/* A COMPLETER */
-					break;
-				case 'u':
-					/* A COMPLETER */
-					break;
-				case 'x':
-					/* A COMPLETER */
-					break;
-				default:
-				    uart_putc(u, *fmt);
-			}
-		} else uart_putc(u, *fmt);
-		fmt++;
-	}
+	fmt_vformat(uart_sink, u, fmt, ap);
 	va_end(ap);
 }
+
+/****************************************************************************
+ *  DMA transmit
+ ***************************************************************************/
+typedef struct {
+	const char	*buf;
+	uint16_t	len;
+	OnUartTx	cb;
+} UartTxReq;
+
+typedef struct {
+	USART_t			*u;
+	DMA_t			*dma;
+	uint32_t		stream;
+	int				channel;
+	DMA_Stream_t	*s;				// NULL until the first write
+	UartTxReq		q[UART_TX_QUEUE];
+	volatile uint32_t	head;		// request being sent
+	volatile uint32_t	tail;		// next free slot
+} UartDmaTx;
+
+#ifdef USE_USART1
+static UartDmaTx usart1_tx = { .u=_USART1, .dma=_DMA2, .stream=7, .channel=4 };
+#endif
+#ifdef USE_USART2
+static UartDmaTx usart2_tx = { .u=_USART2, .dma=_DMA1, .stream=6, .channel=4 };
+#endif
+#ifdef USE_USART6
+static UartDmaTx usart6_tx = { .u=_USART6, .dma=_DMA2, .stream=6, .channel=5 };
+#endif
+
+// start the transfer of the request at the head of the queue
+static void uart_tx_start(UartDmaTx *tx)
+{
+	UartTxReq *r = &tx->q[tx->head % UART_TX_QUEUE];
+	
+	tx->s->M0AR = (uint32_t)r->buf;
+	dma_start(tx->s, r->len);
+}
+
+// transfer complete (DMA interrupt): notify, then chain the next request
+static void uart_tx_done(UartDmaTx *tx)
+{
+	UartTxReq *r = &tx->q[tx->head % UART_TX_QUEUE];
+	
+	tx->head++;
+	if (r->cb) r->cb(r->buf, r->len);
+	if (tx->head != tx->tail) uart_tx_start(tx);
+}
+
+#ifdef USE_USART1
+static void usart1_tx_tc(uint32_t stream, uint32_t bufid) { uart_tx_done(&usart1_tx); }
+#endif
+#ifdef USE_USART2
+static void usart2_tx_tc(uint32_t stream, uint32_t bufid) { uart_tx_done(&usart2_tx); }
+#endif
+#ifdef USE_USART6
+static void usart6_tx_tc(uint32_t stream, uint32_t bufid) { uart_tx_done(&usart6_tx); }
+#endif
+
+/*
+ * uart_write_async : queue buf for a DMA transfer and return
+ */
+int uart_write_async(USART_t *u, const char *buf, uint32_t len, OnUartTx cb)
+{
+	UartDmaTx *tx;
+	OnTC tc;
+	uint32_t primask;
+	
+	if (u == _USART1) {
+#ifdef USE_USART1
+		tx = &usart1_tx; tc = usart1_tx_tc;
+#else
+		return -1;
+#endif
+	} else if (u == _USART2) {
+#ifdef USE_USART2
+		tx = &usart2_tx; tc = usart2_tx_tc;
+#else
+		return -1;
+#endif
+	} else if (u == _USART6) {
+#ifdef USE_USART6
+		tx = &usart6_tx; tc = usart6_tx_tc;
+#else
+		return -1;
+#endif
+	} else {
+		return -1;
+	}
+	
+	if (len == 0 || len > 0xFFFF) return -1;
+	
+	if (!tx->s) {
+		DMAEndPoint_t src = { EP_MEM, NULL, NULL, -1, EP_AUTOINC | EP_FMT_BYTE };
+		DMAEndPoint_t dst = { EP_UART_TX, (void*)&u->DR, NULL, tx->channel, EP_FMT_BYTE };
+		
+		tx->s = dma_stream_init(tx->dma, tx->stream, &src, &dst, STRM_PRIO_MEDIUM, tc);
+		if (!tx->s) return -1;
+		u->CR3 |= (1<<7);			// DMAT: transmitter DMA requests
+	}
+	
+	// the DMA interrupt pops the queue: keep it out while pushing
+	primask = __get_PRIMASK();
+	__disable_irq();
+	if (tx->tail - tx->head == UART_TX_QUEUE) {
+		__set_PRIMASK(primask);
+		return -1;
+	}
+	tx->q[tx->tail % UART_TX_QUEUE] = (UartTxReq){ buf, (uint16_t)len, cb };
+	if (tx->tail++ == tx->head) uart_tx_start(tx);
+	__set_PRIMASK(primask);
+	
+	return 0;
+}
+
+/*
+ * uart_tx_pending : number of DMA transfers queued or in progress
+ */
+uint32_t uart_tx_pending(USART_t *u)
+{
+#ifdef USE_USART1
+	if (u == _USART1) return usart1_tx.tail - usart1_tx.head;
+#endif
+#ifdef USE_USART2
+	if (u == _USART2) return usart2_tx.tail - usart2_tx.head;
+#endif
+#ifdef USE_USART6
+	if (u == _USART6) return usart6_tx.tail - usart6_tx.head;
+#endif
+	return 0;
+}
+
+/****************************************************************************
+ *  DMA receive
+ ***************************************************************************/
+// hand the bytes received since the last call to the consumer, as one
+// span, or two when the DMA has wrapped around the end of the buffer.
+// Only called from the USART interrupt.
+static void uart_rx_flush(UartDmaRx *rx)
+{
+	uint32_t wr = rx->size - rx->s->NDTR;
+	
+	if (wr == rx->size) wr = 0;
+	if (wr < rx->rd) {
+		rx->cb(rx->buf + rx->rd, rx->size - rx->rd);
+		rx->rd = 0;
+	}
+	if (wr > rx->rd) {
+		rx->cb(rx->buf + rx->rd, wr - rx->rd);
+		rx->rd = wr;
+	}
+}
+
+// end of the buffer reached (DMA interrupt): let the USART interrupt
+// flush it, so that the consumer is always called from one context
+#ifdef USE_USART1
+static void usart1_rx_tc(uint32_t stream, uint32_t bufid) { NVIC_SetPendingIRQ(USART1_IRQn); }
+#endif
+#ifdef USE_USART2
+static void usart2_rx_tc(uint32_t stream, uint32_t bufid) { NVIC_SetPendingIRQ(USART2_IRQn); }
+#endif
+#ifdef USE_USART6
+static void usart6_rx_tc(uint32_t stream, uint32_t bufid) { NVIC_SetPendingIRQ(USART6_IRQn); }
+#endif
+
+/*
+ * uart_rx_dma : receive into circular buffer buf by DMA, deliver on idle line
+ */
+int uart_rx_dma(USART_t *u, char *buf, uint32_t size, OnUartRxSpan cb)
+{
+	UartDmaRx *rx;
+	OnTC tc;
+	
+	if (u == _USART1) {
+#ifdef USE_USART1
+		rx = &usart1_rx; tc = usart1_rx_tc;
+#else
+		return -1;
+#endif
+	} else if (u == _USART2) {
+#ifdef USE_USART2
+		rx = &usart2_rx; tc = usart2_rx_tc;
+#else
+		return -1;
+#endif
+	} else if (u == _USART6) {
+#ifdef USE_USART6
+		rx = &usart6_rx; tc = usart6_rx_tc;
+#else
+		return -1;
+#endif
+	} else {
+		return -1;
+	}
+	
+	if (!cb || size == 0 || size > 0xFFFF) return -1;
+	
+	DMAEndPoint_t src = { EP_UART_RX, (void*)&u->DR, NULL, rx->channel, EP_FMT_BYTE };
+	DMAEndPoint_t dst = { EP_MEM, buf, NULL, -1, EP_AUTOINC | EP_FMT_BYTE | EP_BUF_CIRC };
+	
+	NVIC_DisableIRQ(rx->irq);
+	rx->buf = buf;
+	rx->size = size;
+	rx->rd = 0;
+	rx->cb = cb;
+	rx->s = dma_stream_init(rx->dma, rx->stream, &src, &dst, STRM_PRIO_HIGH, tc);
+	if (!rx->s) return -1;
+	
+	u->CR1 &= ~(1<<5);				// no more RXNE interrupt
+	u->CR3 |= (1<<6) | (1<<0);		// DMAR: receiver DMA requests, EIE: overrun
+									// interrupt, as RXNEIE gave
+	dma_start(rx->s, (uint16_t)size);
+	u->CR1 |= (1<<4);				// IDLE interrupt: end of a burst
+	
+	NVIC_SetPriority(rx->irq, 3);
+	NVIC_EnableIRQ(rx->irq);
+	
+	return 0;
+}
@@ -9,6 +9,26 @@ extern "C" {
 
 
 typedef void (*OnUartRx)(char c);
+typedef void (*OnUartTx)(const char *buf, uint32_t len);
+typedef void (*OnUartRxSpan)(const char *buf, uint32_t len);
+
+// Max number of DMA transfers queued per USART by uart_write_async
+#define UART_TX_QUEUE     8
+
+// Size of the interrupt driven transmit ring of each USART (power of 2)
+#ifndef UART_TX_RING
+#define UART_TX_RING      256
+#endif
+
+// What uart_putc does when the transmit ring is full
+#define UART_TX_BLOCK     0     /* wait for room (default) */
+#define UART_TX_DROP      1     /* drop the char, count it in 'dropped' */
+#define UART_TX_REPORT    2     /* return -1, the caller retries */
+
+typedef struct {
+	uint32_t	high_water;	/* max number of chars ever waiting */
+	uint32_t	dropped;	/* chars dropped by UART_TX_DROP */
+} UartTxStats;
 
 
 // Definitions for typical UART 'mode' settings
@@ -32,12 +52,62 @@ typedef void (*OnUartRx)(char c);
 #define UART_8O1          (UART_CHAR_9 | UART_PAR_ODD  | UART_STOP_1)
 #define UART_8O2          (UART_CHAR_9 | UART_PAR_ODD  | UART_STOP_2)
 
+// Largest baud rate error accepted by uart_init, in ppm of the baud rate
+#ifndef UART_BAUD_MAX_ERROR
+#define UART_BAUD_MAX_ERROR   20000
+#endif
+
+/* Baud rates within 1% on USART2 (APB1) / USART1, USART6 (APB2) for each
+ * clock configuration of startup/rcc.c, '*' with 8x oversampling:
+ *
+ *   HSE 8MHz         115.2k  230.4k                  1M*
+ *   HSE 48MHz  APB1  115.2k  230.4k  460.8k  921.6k* 1M*
+ *              APB2  115.2k  230.4k  460.8k  921.6k  1M  2M* 3M*
+ *   HSE 84MHz  APB1  115.2k  230.4k  460.8k  921.6k  1M  2M  3M*
+ *   (default)  APB2  115.2k  230.4k  460.8k  921.6k  1M  2M  3M  4M  6M*
+ *   HSE 96MHz  APB1  115.2k  230.4k  460.8k  921.6k  1M  2M  3M  4M* 6M*
+ *              APB2  115.2k  230.4k  460.8k  921.6k  1M  2M  3M  4M  6M  12M*
+ *   HSI 16MHz        115.2k  230.4k  460.8k          1M  2M*
+ *   HSI 84MHz        as HSE 84MHz
+ *
+ * The x.xxx.200 rates are 0.02% to 0.93% off, the round ones exact.
+ * uart_baud_max() gives the fastest of them for a port at run time.
+ * Rates under fPCLK/65535, whose divider does not fit in BRR, are refused:
+ * below 1282 bauds on the 84MHz APB2 (1200 would need 70000), 641 on the
+ * 42MHz APB1, 1465 on the 96MHz APB2.
+ */
+#define UART_BAUD_PROFILES    { 115200, 230400, 460800, 921600, 1000000, \
+                                2000000, 3000000, 4000000, 6000000, 12000000 }
+
 /*
  * uart_init : initialize with baud, line mode parameters,
- *             polling Tx and IRQ Rx
+ *             interrupt driven Tx ring and IRQ Rx (if cb is not NULL).
+ *             The baud rate divider is rounded to the nearest 1/16 (or
+ *             1/8 with 8x oversampling, used when baud is over
+ *             fPCLK/16). Returns -1 if baud is out of the BRR range
+ *             (over fPCLK/8, under fPCLK/65535) or if the error is over
+ *             UART_BAUD_MAX_ERROR, see uart_baud_error().
  */
 int uart_init(USART_t *u, uint32_t baud, uint32_t mode, OnUartRx cb);
 
+/*
+ * uart_baud_error : error of the baud rate set by uart_init, in ppm
+ *                   (positive: faster than asked)
+ */
+int32_t uart_baud_error(USART_t *u);
+
+/*
+ * uart_baud_max : fastest of UART_BAUD_PROFILES the port can run at with
+ *                 the current clocks, within max_error ppm
+ */
+uint32_t uart_baud_max(USART_t *u, int32_t max_error);
+
+/*
+ * uart_overruns : number of overrun events: the data register was not
+ *                 read in time and at least one received byte was lost
+ */
+uint32_t uart_overruns(USART_t *u);
+
 /*
  * uart_getc : get a char from the serial link (polling)
  */
@@ -50,17 +120,60 @@ char uart_getc(USART_t *u);
 int uart_getchar(USART_t *u, char *pChar);
 
 /*
- * uart_putc : send a char over the serial link (polling)
+ * uart_putc : queue a char in the transmit ring and return; the TXE
+ *             interrupt sends it. Returns 0, or -1 if the ring is full
+ *             and the policy is UART_TX_DROP or UART_TX_REPORT.
+ *             One caller context per USART; with UART_TX_BLOCK, do not
+ *             call with interrupts masked.
+ */
+int uart_putc(USART_t *u, char c);
+
+/*
+ * uart_puts : queue a string in the transmit ring, return the number of
+ *             chars queued
+ */
+int uart_puts(USART_t *u, const char *s);
+
+/*
+ * uart_tx_policy : set what uart_putc does when the ring is full
+ *                  (UART_TX_BLOCK, UART_TX_DROP, UART_TX_REPORT)
+ */
+void uart_tx_policy(USART_t *u, int policy);
+
+/*
+ * uart_tx_stats : transmit ring statistics (high water mark, dropped)
+ */
+const UartTxStats *uart_tx_stats(USART_t *u);
+
+/*
+ * uart_write_async : queue the transfer of len bytes of buf by DMA and
+ *                    return at once. Queued buffers are sent one after
+ *                    the other; cb (if not NULL) is called from the DMA
+ *                    interrupt when buf has been sent and may be reused.
+ *                    Returns 0, or -1 if the queue is full.
+ *                    Do not mix with uart_putc/uart_puts on the same USART
+ *                    while transfers are pending.
+ */
+int uart_write_async(USART_t *u, const char *buf, uint32_t len, OnUartTx cb);
+
+/*
+ * uart_tx_pending : number of DMA transfers queued or in progress
  */
-void uart_putc(USART_t *u, char c);
+uint32_t uart_tx_pending(USART_t *u);
 
 /*
- * uart_puts : send a string over the serial link (polling)
+ * uart_rx_dma : switch the reception of an initialized USART from one
+ *               interrupt per byte to a circular DMA buffer buf of size
+ *               bytes. cb receives the bytes as contiguous spans of buf,
+ *               from the USART interrupt, each time the line goes idle
+ *               after a burst, and when the DMA wraps around. cb must
+ *               consume a span before size more bytes arrive.
+ *               Returns 0, or -1 on error.
  */
-void uart_puts(USART_t *u, const char *s);
+int uart_rx_dma(USART_t *u, char *buf, uint32_t size, OnUartRxSpan cb);
 
 /*
- * uart_printf : print formatted text to serial link
+ * uart_printf : print formatted text to serial link (see lib/fmt.h)
  */
 void uart_printf(USART_t *u, const char* fmt, ...);
 
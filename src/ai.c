@@ -0,0 +1,362 @@
+#include "ai.h"
+
+uint32_t ai_nodes = 0;
+volatile uint32_t ai_stop = 0;
+static int abortable = 0;
+AiTTStats ai_tt_stats;
+
+// Transposition table entry. 'empty' is the number of empty cells of the
+// position, i.e. the height of the subtree it summarizes.
+enum { TT_NONE, TT_EXACT, TT_LOWER, TT_UPPER };
+
+typedef struct {
+    uint32_t key;
+    int8_t   value;
+    uint8_t  flag;
+    uint8_t  move;              // best (or refuting) cell
+    uint8_t  empty;
+} TTEntry;
+
+#define TT_SIZE             (1u << AI_TT_BITS)
+
+#ifdef __arm__
+#define AI_TT_SECTION       __attribute__((section(".ai_tt")))
+#else
+#define AI_TT_SECTION
+#endif
+
+static TTEntry tt[TT_SIZE] AI_TT_SECTION;
+
+// Zobrist keys: one per (side, cell), and one toggled at every move
+static const uint32_t zobrist[2][9] = {
+    {0xD1BFBDE2, 0x4E3764ED, 0x18C247F0, 0xEB9FF885, 0x182FD723,
+     0xDF15008C, 0xA8854049, 0x2B679971, 0x2F604D4F},
+    {0xA1EE723B, 0xB09C1E3F, 0x5C4FA590, 0x2873A668, 0xF34849E8,
+     0xD6163847, 0xB1844E4F, 0x9B3FF45A, 0x51E8EBF4}
+};
+static const uint32_t zobrist_side = 0xC886441A;
+
+// The 8 board symmetries: sym[t][k] is the cell where symmetry t moves
+// cell k. Identity, rotations by 90, 180 and 270 degrees, mirrors about
+// the vertical and horizontal axes, about the main and anti diagonals.
+static const uint8_t sym[8][9] = {
+    {0, 1, 2, 3, 4, 5, 6, 7, 8},
+    {2, 5, 8, 1, 4, 7, 0, 3, 6},
+    {8, 7, 6, 5, 4, 3, 2, 1, 0},
+    {6, 3, 0, 7, 4, 1, 8, 5, 2},
+    {2, 1, 0, 5, 4, 3, 8, 7, 6},
+    {6, 7, 8, 3, 4, 5, 0, 1, 2},
+    {0, 3, 6, 1, 4, 7, 2, 5, 8},
+    {8, 5, 2, 7, 4, 1, 6, 3, 0}
+};
+
+// sym_inverse[t]: the symmetry undoing t
+static const uint8_t sym_inverse[8] = {0, 3, 2, 1, 4, 5, 6, 7};
+
+// The 8 winning lines
+static const uint16_t win_masks[8] = {
+    0x007, 0x038, 0x1C0,        // rows
+    0x049, 0x092, 0x124,        // columns
+    0x111, 0x054                // diagonals
+};
+
+// Line counter increment for each cell: 1 in the 4-bit field of every
+// line through the cell (see Position.lines)
+static const uint32_t cell_lines[9] = {
+    0x01001001, 0x00010001, 0x10100001,
+    0x00001010, 0x11010010, 0x00100010,
+    0x10001100, 0x00010100, 0x01100100
+};
+
+// A line counter reaches 3 iff adding 1 to it sets bit 2 of its field
+#define LINES_WON(l)        ((((l) + 0x11111111u) & 0x44444444u) != 0)
+
+// Move ordering: center, then corners, then edges. The strongest moves
+// come first so that alpha-beta cuts early.
+static const uint16_t order_masks[3] = {0x010, 0x145, 0x0AA};
+
+// Index of the lowest set bit of a non-zero mask (rbit + clz on the M4)
+#define LOWEST_CELL(m)      __builtin_ctz(m)
+
+void ai_init(void) {
+    for (uint32_t i = 0; i < TT_SIZE; ++i) {
+        tt[i].key = 0;
+        tt[i].flag = TT_NONE;
+    }
+    ai_tt_stats.hits = ai_tt_stats.misses = 0;
+    ai_tt_stats.stores = ai_tt_stats.replaced = 0;
+}
+
+int ai_check_win(uint32_t side) {
+    for (int i = 0; i < 8; ++i) {
+        if ((side & win_masks[i]) == win_masks[i]) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int ai_check_draw(Board b) {
+    return (b.x | b.o) == AI_CELLS;
+}
+
+void ai_position_init(Position *p, Board b, int side) {
+    p->b = b;
+    p->lines[0] = p->lines[1] = 0;
+    p->moves = 0;
+    p->side = (uint8_t)side;
+    for (int t = 0; t < 8; ++t) {
+        p->keys[t] = side ? zobrist_side : 0;
+    }
+    for (int k = 0; k < 9; ++k) {
+        int owner;
+        if (b.x & (1u << k)) {
+            owner = 0;
+        } else if (b.o & (1u << k)) {
+            owner = 1;
+        } else {
+            continue;
+        }
+        p->lines[owner] += cell_lines[k];
+        for (int t = 0; t < 8; ++t) {
+            p->keys[t] ^= zobrist[owner][sym[t][k]];
+        }
+        p->moves++;
+    }
+}
+
+int ai_make(Position *p, int k) {
+    int side = p->side;
+
+    if (side) {
+        p->b.o |= (uint16_t)(1u << k);
+    } else {
+        p->b.x |= (uint16_t)(1u << k);
+    }
+    p->lines[side] += cell_lines[k];
+    for (int t = 0; t < 8; ++t) {
+        p->keys[t] ^= zobrist[side][sym[t][k]] ^ zobrist_side;
+    }
+    p->moves++;
+    p->side = (uint8_t)(side ^ 1);
+
+    // only the lines through k have changed
+    return LINES_WON(p->lines[side]);
+}
+
+void ai_unmake(Position *p, int k) {
+    int side = p->side ^ 1;
+
+    if (side) {
+        p->b.o &= (uint16_t)~(1u << k);
+    } else {
+        p->b.x &= (uint16_t)~(1u << k);
+    }
+    p->lines[side] -= cell_lines[k];
+    for (int t = 0; t < 8; ++t) {
+        p->keys[t] ^= zobrist[side][sym[t][k]] ^ zobrist_side;
+    }
+    p->moves--;
+    p->side = (uint8_t)side;
+}
+
+// Canonical key of p: the smallest of its 8 symmetric keys. *t receives
+// the symmetry that maps p onto its canonical form.
+static uint32_t canonical_key(const Position *p, int *t) {
+    uint32_t key = p->keys[0];
+
+    *t = 0;
+    for (int i = 1; i < 8; ++i) {
+        if (p->keys[i] < key) {
+            key = p->keys[i];
+            *t = i;
+        }
+    }
+    return key;
+}
+
+// Store a search result under canonical key 'key', unless the slot holds
+// another position with a bigger subtree (depth-preferred replacement).
+// 'move' is already expressed in canonical coordinates.
+static void tt_store(TTEntry *e, uint32_t key, Position *p, int value,
+                     int flag, int move) {
+    uint8_t empty = (uint8_t)(9 - p->moves);
+
+    if (e->flag != TT_NONE && e->key != key) {
+        if (e->empty > empty) {
+            return;
+        }
+        ai_tt_stats.replaced++;
+    }
+    e->key = key;
+    e->value = (int8_t)value;
+    e->flag = (uint8_t)flag;
+    e->move = (uint8_t)move;
+    e->empty = empty;
+    ai_tt_stats.stores++;
+}
+
+// Game value of position p for the side to move, searched in the window
+// ]alpha, beta[. The caller has already checked the last move for a win.
+static int negamax(Position *p, int alpha, int beta) {
+    uint32_t empty = ~(p->b.x | p->b.o) & AI_CELLS;
+    TTEntry *e;
+    uint32_t key, first = 0;
+    int t;
+    int alpha0 = alpha;
+    int best = -2, best_k = 0;
+
+    ai_nodes++;
+
+    if (p->moves == 9) {
+        return 0;       // draw
+    }
+    if (abortable && ai_stop) {
+        return 0;       // the result is thrown away
+    }
+
+    key = canonical_key(p, &t);
+    e = &tt[key & (TT_SIZE - 1)];
+    if (e->flag != TT_NONE && e->key == key) {
+        ai_tt_stats.hits++;
+        if (e->flag == TT_EXACT ||
+            (e->flag == TT_LOWER && e->value >= beta) ||
+            (e->flag == TT_UPPER && e->value <= alpha)) {
+            return e->value;
+        }
+        // try the stored move first, mapped back onto this board
+        first = 1u << sym[sym_inverse[t]][e->move];
+    } else {
+        ai_tt_stats.misses++;
+    }
+
+    for (int g = -1; g < 3; ++g) {
+        uint32_t m = (g < 0) ? first : (empty & order_masks[g] & ~first);
+        for (; m; m &= m - 1) {
+            int k = LOWEST_CELL(m);
+            int score;
+
+            if (ai_make(p, k)) {
+                ai_nodes++;
+                score = 1;
+            } else {
+                score = -negamax(p, -beta, -alpha);
+            }
+            ai_unmake(p, k);
+
+            if (abortable && ai_stop) {
+                return 0;
+            }
+            if (score > best) {
+                best = score;
+                best_k = k;
+                if (best > alpha) {
+                    alpha = best;
+                    if (alpha >= beta) {
+                        // the opponent will avoid this line
+                        tt_store(e, key, p, best, TT_LOWER, sym[t][best_k]);
+                        return best;
+                    }
+                }
+            }
+        }
+    }
+
+    tt_store(e, key, p, best, best <= alpha0 ? TT_UPPER : TT_EXACT,
+             sym[t][best_k]);
+    return best;
+}
+
+int ai_best_move(Board b, int *row, int *col) {
+    return ai_search(b, row, col, 0);
+}
+
+int ai_search(Board b, int *row, int *col, int stop) {
+    uint32_t empty = ~(b.x | b.o) & AI_CELLS;
+    int best = AI_NO_MOVE;
+    Position p;
+
+    ai_position_init(&p, b, 1);
+    abortable = stop;
+
+    // The root keeps row-major order: any later move must be strictly
+    // better to be chosen, exactly like the plain minimax did.
+    for (uint32_t m = empty; m; m &= m - 1) {
+        int k = LOWEST_CELL(m);
+        int score;
+
+        if (LINES_WON(p.lines[0])) {
+            score = -1;     // already lost, every move is worth the same
+        } else if (ai_make(&p, k)) {
+            ai_nodes++;
+            ai_unmake(&p, k);
+            score = 1;
+        } else {
+            score = -negamax(&p, -1, -best);
+            ai_unmake(&p, k);
+            if (stop && ai_stop) {
+                return AI_ABORTED;
+            }
+        }
+
+        if (score > best) {
+            best = score;
+            *row = k / 3;
+            *col = k % 3;
+            if (best == 1) {
+                break;
+            }
+        }
+    }
+    return best;
+}
+
+int ai_analyze(Board b, int8_t values[9]) {
+    int nx = __builtin_popcount(b.x), no = __builtin_popcount(b.o);
+    uint32_t empty = ~(b.x | b.o) & AI_CELLS;
+    int n = 0;
+    Position p;
+
+    for (int k = 0; k < 9; ++k) {
+        values[k] = AI_NO_VALUE;
+    }
+    if ((b.x & b.o) || ((b.x | b.o) & ~AI_CELLS) || nx < no || nx > no + 1) {
+        return -1;
+    }
+    if (ai_check_win(b.x) || ai_check_win(b.o)) {
+        return 0;
+    }
+
+    ai_position_init(&p, b, nx > no);
+    abortable = 0;
+
+    // Values are -1, 0 or 1: the window ]-1, 1[ makes every result exact
+    for (uint32_t m = empty; m; m &= m - 1) {
+        int k = LOWEST_CELL(m);
+
+        if (ai_make(&p, k)) {
+            ai_nodes++;
+            values[k] = 1;
+        } else {
+            values[k] = (int8_t)-negamax(&p, -1, 1);
+        }
+        ai_unmake(&p, k);
+        n++;
+    }
+    return n;
+}
+
+int ai_board_from_index(uint32_t i, Board *b) {
+    if (i >= 19683) {
+        return -1;
+    }
+    b->x = b->o = 0;
+    for (int k = 0; k < 9; ++k, i /= 3) {
+        if (i % 3 == 1) {
+            b->x |= (uint16_t)(1u << k);
+        } else if (i % 3 == 2) {
+            b->o |= (uint16_t)(1u << k);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,134 @@
+#ifndef _AI_H_
+#define _AI_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#define AI_NO_MOVE      (-2)    /* no empty cell left on the board */
+#define AI_ABORTED      (-4)    /* search stopped by ai_stop */
+#define AI_NO_VALUE     (-128)  /* ai_analyze(): cell not playable */
+
+/* Bitboard: one 9-bit mask per side, bit (row * 3 + col) set when the
+ * side holds cell (row, col). The whole board fits in one 32-bit register.
+ * AI_HUMAN ('X') always moves first, AI_CPU ('O') is the board.
+ */
+typedef struct {
+    uint16_t x;                 /* AI_HUMAN cells */
+    uint16_t o;                 /* AI_CPU cells */
+} Board;
+
+#define AI_CELLS        (0x1FFu)
+#define AI_CELL(row, col)       (1u << ((row) * 3 + (col)))
+
+/* Search position, updated incrementally by ai_make()/ai_unmake().
+ * lines[side] holds one 4-bit counter per winning line (line i in bits
+ * 4i..4i+3): the number of cells the side owns on that line.
+ * keys[t] is the Zobrist hash of the board seen through symmetry t (the
+ * 4 rotations and 4 reflections, t = 0 is the board itself); the
+ * smallest one is the same for all 8 equivalent boards.
+ */
+typedef struct {
+    Board    b;
+    uint32_t lines[2];          /* 0: AI_HUMAN, 1: AI_CPU */
+    uint32_t keys[8];           /* Zobrist hashes of b and side */
+    uint8_t  moves;             /* cells played */
+    uint8_t  side;              /* side to move, 0: AI_HUMAN, 1: AI_CPU */
+} Position;
+
+/* Transposition table: 2^AI_TT_BITS entries of 8 bytes, placed in the
+ * .ai_tt RAM section (config/stm32f411re_flash.lds). Positions are
+ * stored once per symmetry class, under their canonical key.
+ */
+#ifndef AI_TT_BITS
+#define AI_TT_BITS      12
+#endif
+
+typedef struct {
+    uint32_t hits;              /* probes that found the position */
+    uint32_t misses;            /* probes that did not */
+    uint32_t stores;            /* entries written */
+    uint32_t replaced;          /* stores that evicted another position */
+} AiTTStats;
+
+extern AiTTStats ai_tt_stats;
+
+/* ai_nodes
+ *   number of positions visited by the search since the last reset
+ */
+extern uint32_t ai_nodes;
+
+/* ai_stop
+ *   set (e.g. from an interrupt) to stop an abortable search at once
+ */
+extern volatile uint32_t ai_stop;
+
+/* ai_init
+ *   clear the transposition table and its statistics, must be called
+ *   before the first search (the table is not zeroed at startup)
+ */
+void ai_init(void);
+
+/* ai_check_win
+ *   return 1 if the cells in mask 'side' complete one of the 8 lines
+ */
+int ai_check_win(uint32_t side);
+
+/* ai_check_draw
+ *   return 1 if no empty cell is left on board b
+ */
+int ai_check_draw(Board b);
+
+/* ai_position_init
+ *   set up position p from board b, 'side' to move
+ */
+void ai_position_init(Position *p, Board b, int side);
+
+/* ai_make
+ *   play empty cell k (row * 3 + col) for the side to move, return 1 if
+ *   the move wins the game
+ */
+int ai_make(Position *p, int k);
+
+/* ai_unmake
+ *   take back the last move, played on cell k
+ */
+void ai_unmake(Position *p, int k);
+
+/* ai_best_move
+ *   alpha-beta (negamax) search of the best move for AI_CPU on board b.
+ *   The move is written to (*row, *col) and its game value is returned
+ *   (1 win, 0 draw, -1 loss), or AI_NO_MOVE if the board is full.
+ *   Ties are broken like the former plain minimax: first best cell in
+ *   row-major order.
+ */
+int ai_best_move(Board b, int *row, int *col);
+
+/* ai_search
+ *   same as ai_best_move(). If 'abortable' is set, the search returns
+ *   AI_ABORTED as soon as ai_stop is set, without polluting the
+ *   transposition table; the caller clears ai_stop beforehand.
+ */
+int ai_search(Board b, int *row, int *col, int abortable);
+
+/* ai_analyze
+ *   game value of every move on board b for the side to move (AI_HUMAN
+ *   when both sides hold as many cells, AI_CPU otherwise): values[k] is
+ *   1 (win), 0 (draw) or -1 (loss) for each empty cell k, AI_NO_VALUE for
+ *   the others. Return the number of moves, 0 if the game is over, or -1
+ *   if b cannot occur in a game (cell counts).
+ */
+int ai_analyze(Board b, int8_t values[9]);
+
+/* ai_board_from_index
+ *   board of base-3 index i (cell k counts 3^k times 0, 1 for X or 2 for
+ *   O), return -1 if i is over 3^9 - 1
+ */
+int ai_board_from_index(uint32_t i, Board *b);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
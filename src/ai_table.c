@@ -0,0 +1,40 @@
+#include "src/ai_table.h"
+
+int ai_mode = AI_MODE_DEFAULT;
+uint32_t ai_table_errors = 0;
+
+int ai_table_best_move(Board b, int *row, int *col) {
+    uint8_t e = ai_table.moves[ai_table.base3[b.x] + 2 * ai_table.base3[b.o]];
+
+    if (e == AI_TABLE_NONE) {
+        return AI_NOT_FOUND;
+    }
+    *row = AI_TABLE_CELL(e) / 3;
+    *col = AI_TABLE_CELL(e) % 3;
+    return AI_TABLE_VALUE(e);
+}
+
+int ai_play(Board b, int *row, int *col) {
+    int score, trow, tcol, tscore;
+
+    switch (ai_mode) {
+    case AI_MODE_TABLE:
+        score = ai_table_best_move(b, row, col);
+        if (score != AI_NOT_FOUND) {
+            return score;
+        }
+        return ai_best_move(b, row, col);   // finished game, odd position
+
+    case AI_MODE_VERIFY:
+        score = ai_best_move(b, row, col);
+        tscore = ai_table_best_move(b, &trow, &tcol);
+        if (tscore != AI_NOT_FOUND &&
+            (tscore != score || trow != *row || tcol != *col)) {
+            ai_table_errors++;
+        }
+        return score;
+
+    default:
+        return ai_best_move(b, row, col);
+    }
+}
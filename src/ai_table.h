@@ -0,0 +1,69 @@
+#ifndef _AI_TABLE_H_
+#define _AI_TABLE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "src/ai.h"
+
+/* Perfect-play move table in FLASH (.rodata), generated at build time by
+ * tools/gen_table.c into src/ai_table_data.c, or solved by the compiler
+ * from src/ai_table.hpp (make table=constexpr).
+ *
+ * Positions are indexed by their base-3 number: cell k counts 3^k times
+ * 0 (empty), 1 (X) or 2 (O), i.e. base3[b.x] + 2 * base3[b.o].
+ * Each entry holds the best cell for the AI (bits 0-3) and the game
+ * value + 1 (bits 4-5), or AI_TABLE_NONE if the game is over or it is
+ * not the AI's turn.
+ */
+#define AI_TABLE_SIZE           19683       /* 3^9 */
+#define AI_TABLE_NONE           0xFF
+
+#define AI_TABLE_ENTRY(k, value)    ((uint8_t)((k) | (((value) + 1) << 4)))
+#define AI_TABLE_CELL(e)            ((e) & 0x0F)
+#define AI_TABLE_VALUE(e)           ((int)((e) >> 4) - 1)
+
+typedef struct {
+    uint16_t base3[512];        /* base-3 index of the cells of a mask */
+    uint8_t  moves[AI_TABLE_SIZE];
+} AiTable;
+
+extern const AiTable ai_table;
+
+/* Where ai_play() gets its moves from */
+enum {
+    AI_MODE_TABLE,      /* table lookup, search when not in the table */
+    AI_MODE_SEARCH,     /* search only */
+    AI_MODE_VERIFY      /* search, and check the table against it */
+};
+
+#ifndef AI_MODE_DEFAULT
+#define AI_MODE_DEFAULT         AI_MODE_TABLE
+#endif
+
+#define AI_NOT_FOUND            (-3)
+
+extern int ai_mode;
+
+/* ai_table_errors
+ *   number of AI_MODE_VERIFY moves where table and search disagreed
+ */
+extern uint32_t ai_table_errors;
+
+/* ai_table_best_move
+ *   best move for AI_CPU on board b, from the table. Same results as
+ *   ai_best_move(), or AI_NOT_FOUND if b is not in the table.
+ */
+int ai_table_best_move(Board b, int *row, int *col);
+
+/* ai_play
+ *   best move for AI_CPU on board b, according to ai_mode
+ */
+int ai_play(Board b, int *row, int *col);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
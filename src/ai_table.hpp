@@ -0,0 +1,144 @@
+#ifndef _AI_TABLE_HPP_
+#define _AI_TABLE_HPP_
+
+/* Compile-time (C++17 constexpr) solver of the 3x3 game.
+ *
+ * ai_cx::solve() builds the same AiTable as tools/gen_table.c, entirely
+ * in the compiler: plain negamax over all 3^9 base-3 board indices,
+ * memoized bottom-up from the full boards down to the empty one. The
+ * best move is the first best cell in row-major order, as ai_best_move()
+ * picks it. Including this header costs nothing at run time.
+ */
+
+#include <stdint.h>
+#include "src/ai_table.h"
+
+namespace ai_cx {
+
+constexpr uint16_t win_masks[8] = {
+    0x007, 0x038, 0x1C0, 0x049, 0x092, 0x124, 0x111, 0x054
+};
+
+constexpr bool wins(unsigned m) {
+    for (uint16_t w : win_masks) {
+        if ((m & w) == w) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Cell contents of base-3 index i: 0 empty, 1 X, 2 O
+struct Cells {
+    uint8_t  c[9];
+    unsigned x, o, nx, no;
+};
+
+constexpr Cells decode(int i) {
+    Cells d{};
+    for (int k = 0; k < 9; ++k, i /= 3) {
+        d.c[k] = (uint8_t)(i % 3);
+        if (d.c[k] == 1) {
+            d.x |= 1u << k;
+            d.nx++;
+        } else if (d.c[k] == 2) {
+            d.o |= 1u << k;
+            d.no++;
+        }
+    }
+    return d;
+}
+
+constexpr AiTable solve() {
+    AiTable t{};
+    int8_t value[AI_TABLE_SIZE] = {};   // game value for the side to move
+    int pow3[9] = {};
+
+    pow3[0] = 1;
+    for (int k = 1; k < 9; ++k) {
+        pow3[k] = pow3[k - 1] * 3;
+    }
+    for (unsigned m = 0; m < 512; ++m) {
+        for (int k = 0; k < 9; ++k) {
+            if (m & (1u << k)) {
+                t.base3[m] = (uint16_t)(t.base3[m] + pow3[k]);
+            }
+        }
+    }
+
+    for (uint8_t &e : t.moves) {
+        e = AI_TABLE_NONE;
+    }
+
+    // children have one more cell played: solve from full boards down
+    for (unsigned played = 9; played + 1 > 0; --played) {
+        for (int i = 0; i < AI_TABLE_SIZE; ++i) {
+            Cells d = decode(i);
+            bool o_turn = (d.nx == d.no + 1);
+
+            if (d.nx + d.no != played || (d.nx != d.no && !o_turn)) {
+                continue;
+            }
+            if (wins(o_turn ? d.o : d.x)) {
+                value[i] = 1;       // unreachable, never read
+                continue;
+            }
+            if (wins(o_turn ? d.x : d.o)) {
+                value[i] = -1;      // the last move won
+                continue;
+            }
+            if (played == 9) {
+                value[i] = 0;
+                continue;
+            }
+
+            int best = -2, best_k = 0;
+            for (int k = 0; k < 9; ++k) {
+                if (d.c[k] == 0) {
+                    int score = -value[i + pow3[k] * (o_turn ? 2 : 1)];
+                    if (score > best) {
+                        best = score;
+                        best_k = k;
+                    }
+                }
+            }
+            value[i] = (int8_t)best;
+            if (o_turn) {
+                t.moves[i] = AI_TABLE_ENTRY(best_k, best);
+            }
+        }
+    }
+    return t;
+}
+
+constexpr AiTable table = solve();
+
+// Entry of the position with X on cells x and O on cells o
+constexpr uint8_t entry(unsigned x, unsigned o) {
+    return table.moves[table.base3[x] + 2 * table.base3[o]];
+}
+
+constexpr int solved() {
+    int n = 0;
+    for (uint8_t e : table.moves) {
+        n += (e != AI_TABLE_NONE);
+    }
+    return n;
+}
+
+// Known positions, as solved at run time by ai_best_move()
+static_assert(solved() == 2097, "unfinished positions with O to play");
+static_assert(entry(0x010, 0x000) == AI_TABLE_ENTRY(0, 0), "X center");
+static_assert(entry(0x001, 0x000) == AI_TABLE_ENTRY(4, 0), "X corner");
+static_assert(entry(0x002, 0x000) == AI_TABLE_ENTRY(0, 0), "X edge");
+static_assert(entry(0x011, 0x100) == AI_TABLE_ENTRY(2, 0), "block diagonal");
+static_assert(entry(0x003, 0x010) == AI_TABLE_ENTRY(2, 0), "block row");
+static_assert(entry(0x101, 0x010) == AI_TABLE_ENTRY(1, 0), "opposite corners");
+static_assert(entry(0x0C1, 0x014) == AI_TABLE_ENTRY(1, -1), "double threat");
+static_assert(entry(0x00B, 0x014) == AI_TABLE_ENTRY(6, 1), "win diagonal");
+static_assert(entry(0x007, 0x018) == AI_TABLE_NONE, "X has won");
+static_assert(entry(0x000, 0x000) == AI_TABLE_NONE, "X to play");
+
+} // namespace ai_cx
+
+#endif
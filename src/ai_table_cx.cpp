@@ -0,0 +1,5 @@
+// Move table solved by the compiler (make table=constexpr), in place of
+// the one generated by tools/gen_table.c
+#include "src/ai_table.hpp"
+
+extern "C" const AiTable ai_table = ai_cx::table;
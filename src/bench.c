@@ -0,0 +1,795 @@
+#include <string.h>
+#include <stdarg.h>
+#include <math.h>
+#include "include/board.h"
+#include "lib/term.h"
+#include "lib/ring.h"
+#include "lib/fmt.h"
+#include "src/ai.h"
+#include "src/ai_table.h"
+#include "src/proto.h"
+#include "src/session.h"
+#include "src/display.h"
+#include "src/board_view.h"
+#include "src/bench.h"
+
+BenchSearch bench_empty;
+BenchSearch bench_all;
+BenchRing bench_ring;
+BenchProto bench_proto;
+BenchAnalyze bench_analyze;
+BenchSession bench_sessions[2];
+BenchFmt bench_fmt;
+BenchDisplay bench_display;
+
+/****************************************************************************
+ *  reference: the plain minimax the engine replaced, kept verbatim but
+ *  for (void) prototypes and casts of the fmax/fmin results
+ ***************************************************************************/
+static char ticTacToe[3][3];
+static uint32_t legacy_nodes;
+
+static int check_win(char player) {
+    for (int i = 0; i < 3; ++i) {
+        if ((ticTacToe[i][0] == player && ticTacToe[i][1] == player && ticTacToe[i][2] == player) ||
+            (ticTacToe[0][i] == player && ticTacToe[1][i] == player && ticTacToe[2][i] == player)) {
+            return 1;
+        }
+    }
+
+    if ((ticTacToe[0][0] == player && ticTacToe[1][1] == player && ticTacToe[2][2] == player) ||
+        (ticTacToe[0][2] == player && ticTacToe[1][1] == player && ticTacToe[2][0] == player)) {
+        return 1;
+    }
+
+    return 0;
+}
+
+static int check_draw(void) {
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            if (ticTacToe[i][j] == ' ') {
+                return 0;
+            }
+        }
+    }
+    return 1;
+}
+
+static int evaluate_board(void) {
+    if (check_win('X')) {
+        return -1; // Player X wins
+    } else if (check_win('O')) {
+        return 1; // Player O wins
+    } else if (check_draw()) {
+        return 0; // Draw
+    } else {
+        return -2; // Game is still ongoing
+    }
+}
+
+static int minimax(int depth, int is_maximizer) {
+    int score = evaluate_board();
+
+    legacy_nodes++;
+
+    if (score != -2) {
+        return score;
+    }
+
+    if (depth == 9) {
+        return 0; // Maximum depth reached, return neutral score
+    }
+
+    if (is_maximizer) {
+        int best_score = -1000;
+        for (int i = 0; i < 3; ++i) {
+            for (int j = 0; j < 3; ++j) {
+                if (ticTacToe[i][j] == ' ') {
+                    ticTacToe[i][j] = 'O'; // AI's move
+                    best_score = (int)fmax(best_score, minimax(depth + 1, !is_maximizer));
+                    ticTacToe[i][j] = ' '; // Undo move
+                }
+            }
+        }
+        return best_score;
+    } else {
+        int best_score = 1000;
+        for (int i = 0; i < 3; ++i) {
+            for (int j = 0; j < 3; ++j) {
+                if (ticTacToe[i][j] == ' ') {
+                    ticTacToe[i][j] = 'X'; // Player's move
+                    best_score = (int)fmin(best_score, minimax(depth + 1, !is_maximizer));
+                    ticTacToe[i][j] = ' '; // Undo move
+                }
+            }
+        }
+        return best_score;
+    }
+}
+
+// The same search on integers only: no promotion to double, no libm call
+static int minimax_int(int depth, int is_maximizer) {
+    int score = evaluate_board();
+
+    if (score != -2) {
+        return score;
+    }
+
+    if (depth == 9) {
+        return 0;
+    }
+
+    int best_score = is_maximizer ? -1000 : 1000;
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            if (ticTacToe[i][j] == ' ') {
+                ticTacToe[i][j] = is_maximizer ? 'O' : 'X';
+                score = minimax_int(depth + 1, !is_maximizer);
+                ticTacToe[i][j] = ' ';
+                if (is_maximizer ? score > best_score : score < best_score) {
+                    best_score = score;
+                }
+            }
+        }
+    }
+    return best_score;
+}
+
+// Root loop of the former ft_cb()
+static int legacy_best_move(int (*search)(int, int), int *row, int *col) {
+    int bestScore = -1000;
+
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            if (ticTacToe[i][j] == ' ') {
+                ticTacToe[i][j] = 'O';
+                int score = search(0, 0);
+                ticTacToe[i][j] = ' ';
+
+                if (score > bestScore) {
+                    bestScore = score;
+                    *row = i;
+                    *col = j;
+                }
+            }
+        }
+    }
+    return bestScore;
+}
+
+/****************************************************************************
+ *  benchmark
+ ***************************************************************************/
+static void cycles_init(void) {
+    _CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    _DWT->CYCCNT = 0;
+    _DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+// Search board b with both engines and accumulate the counters in r
+static void bench_position(char b[3][3], BenchSearch *r) {
+    int lrow = -1, lcol = -1, row = -1, col = -1;
+    Board board = {0, 0};
+    uint32_t t0;
+
+    for (int k = 0; k < 9; ++k) {
+        if (b[k / 3][k % 3] == 'X') {
+            board.x |= (uint16_t)(1u << k);
+        } else if (b[k / 3][k % 3] == 'O') {
+            board.o |= (uint16_t)(1u << k);
+        }
+    }
+
+    memcpy(ticTacToe, b, sizeof(ticTacToe));
+    legacy_nodes = 0;
+    t0 = _DWT->CYCCNT;
+    legacy_best_move(minimax, &lrow, &lcol);
+    r->legacy_cycles += _DWT->CYCCNT - t0;
+    r->legacy_nodes += legacy_nodes;
+
+    t0 = _DWT->CYCCNT;
+    legacy_best_move(minimax_int, &lrow, &lcol);
+    r->legacy_int_cycles += _DWT->CYCCNT - t0;
+
+    ai_init();          // cold table: every search starts from scratch
+    ai_nodes = 0;
+    t0 = _DWT->CYCCNT;
+    ai_best_move(board, &row, &col);
+    r->ai_cycles += _DWT->CYCCNT - t0;
+    r->ai_nodes += ai_nodes;
+    r->tt_hits += ai_tt_stats.hits;
+    r->tt_misses += ai_tt_stats.misses;
+
+    r->positions++;
+    if (lrow != row || lcol != col) {
+        r->mismatches++;
+    }
+
+    t0 = _DWT->CYCCNT;
+    int tscore = ai_table_best_move(board, &lrow, &lcol);
+    r->table_cycles += _DWT->CYCCNT - t0;
+    if (tscore != AI_NOT_FOUND && (lrow != row || lcol != col)) {
+        r->table_mismatches++;
+    }
+}
+
+// Walk every position reachable from the empty board with X to play first,
+// and bench the ones where the AI (O) is to play. 'seen' has one bit per
+// base-3 board index.
+static uint8_t seen[19683 / 8 + 1];
+
+static void bench_walk(char b[3][3], int index, int pow3[9], char side) {
+    char *cell = &b[0][0];
+
+    if (seen[index >> 3] & (1 << (index & 7))) {
+        return;
+    }
+    seen[index >> 3] |= (uint8_t)(1 << (index & 7));
+
+    memcpy(ticTacToe, b, sizeof(ticTacToe));
+    if (evaluate_board() != -2) {
+        return;     // game over
+    }
+    if (side == 'O') {
+        bench_position(b, &bench_all);
+    }
+
+    for (int k = 0; k < 9; ++k) {
+        if (cell[k] == ' ') {
+            cell[k] = side;
+            bench_walk(b, index + pow3[k] * (side == 'X' ? 1 : 2), pow3,
+                       side == 'X' ? 'O' : 'X');
+            cell[k] = ' ';
+        }
+    }
+}
+
+/****************************************************************************
+ *  ring buffers
+ ***************************************************************************/
+// The ring term.c used before lib/ring.h, kept verbatim
+#define RING_BUF_SIZE	64
+
+typedef volatile struct RingBuffer {
+	char buf[RING_BUF_SIZE];
+	int  i_push;		/* pointeur (index) d'écriture */
+	int  i_pop;		/* pointeur (index) de lecture */
+} RingBuffer;
+
+static RingBuffer legacy_ring;
+
+static void legacy_push(char c)
+{
+    // Si le buffer n'est pas plein
+    if ((legacy_ring.i_push + 1) % RING_BUF_SIZE != legacy_ring.i_pop) {
+        // Ecrire le caractère dans le buffer
+        legacy_ring.buf[legacy_ring.i_push] = c;
+        // Incrémenter l'index d'écriture
+        legacy_ring.i_push = (legacy_ring.i_push + 1) % RING_BUF_SIZE;
+    }
+}
+
+static char legacy_pop(void)
+{
+	unsigned char c;
+
+    // Lire un caractère
+    c = legacy_ring.buf[legacy_ring.i_pop];
+    // Incrémenter l'index de lecture
+    legacy_ring.i_pop = (legacy_ring.i_pop + 1) % RING_BUF_SIZE;
+
+	return c;
+}
+
+#define RING_BURST      48      // bytes per burst, as a DMA idle-line span
+#define RING_BURSTS     1024
+
+// Bytes of the burst read back wrong, or not read back at all (n short)
+static uint32_t ring_errors(const char *in, const char *out, uint32_t n) {
+    uint32_t errors = RING_BURST - n;
+
+    for (uint32_t i = 0; i < n; ++i) {
+        errors += (uint32_t)(in[i] != out[i]);
+    }
+    return errors;
+}
+
+// Each burst is checked byte for byte, outside the timed part
+static void bench_rings(BenchRing *r) {
+    static char data[64];
+    Ring ring = RING_INIT(data);
+    char in[RING_BURST], out[RING_BURST];
+    uint32_t t0, n;
+
+    r->bytes = RING_BURST * RING_BURSTS;
+
+    for (int b = 0; b < RING_BURSTS; ++b) {
+        for (int i = 0; i < RING_BURST; ++i) {
+            in[i] = (char)(b + i);      // a different burst each time
+        }
+
+        t0 = _DWT->CYCCNT;
+        for (int i = 0; i < RING_BURST; ++i) legacy_push(in[i]);
+        for (int i = 0; i < RING_BURST; ++i) out[i] = legacy_pop();
+        r->modulo_cycles += _DWT->CYCCNT - t0;
+        r->errors += ring_errors(in, out, RING_BURST);
+
+        t0 = _DWT->CYCCNT;
+        for (int i = 0; i < RING_BURST; ++i) ring_push(&ring, in[i]);
+        for (int i = 0; i < RING_BURST; ++i) out[i] = (char)ring_pop(&ring);
+        r->byte_cycles += _DWT->CYCCNT - t0;
+        r->errors += ring_errors(in, out, RING_BURST);
+
+        t0 = _DWT->CYCCNT;
+        n = ring_write(&ring, in, RING_BURST);
+        n = ring_read(&ring, out, n);
+        r->span_cycles += _DWT->CYCCNT - t0;
+        r->errors += ring_errors(in, out, n);
+    }
+}
+
+/****************************************************************************
+ *  protocol parser
+ ***************************************************************************/
+static uint32_t rand_state = 1;
+
+static uint32_t bench_rand(void) {
+    rand_state ^= rand_state << 13;     // xorshift32
+    rand_state ^= rand_state >> 17;
+    rand_state ^= rand_state << 5;
+    return rand_state;
+}
+
+#define PROTO_FRAMES    256
+
+static uint8_t proto_stream[PROTO_FRAMES * (PROTO_FRAME_MAX + 32)];
+static uint8_t proto_sent[PROTO_FRAMES][PROTO_MAX_PAYLOAD + 1];  // len, payload
+static BenchProto *proto_result;
+
+static void bench_on_frame(const ProtoFrame *f) {
+    const uint8_t *sent = proto_sent[f->seq];
+
+    proto_result->received++;
+    if (f->type != PROTO_F_CMD || f->len != sent[0] ||
+        memcmp(f->payload, sent + 1, f->len) != 0) {
+        proto_result->corrupted++;
+    }
+}
+
+static void bench_protocol(BenchProto *r) {
+    uint8_t payload[PROTO_MAX_PAYLOAD];
+    ProtoParser p;
+    uint32_t len = 0, t0;
+
+    // Build the stream: noise, then a frame, PROTO_FRAMES times
+    for (int n = 0; n < PROTO_FRAMES; ++n) {
+        uint32_t noise = bench_rand() % 32;
+        uint32_t plen = bench_rand() % (PROTO_MAX_PAYLOAD + 1);
+
+        while (noise--) {
+            proto_stream[len++] = (uint8_t)bench_rand();
+        }
+        for (uint32_t i = 0; i < plen; ++i) {
+            payload[i] = (uint8_t)bench_rand();
+        }
+        proto_sent[n][0] = (uint8_t)plen;
+        memcpy(proto_sent[n] + 1, payload, plen);
+        len += proto_frame(proto_stream + len, PROTO_F_CMD, (uint8_t)n, payload, plen);
+        r->frames++;
+    }
+    r->bytes = len;
+
+    // Parse it in chunks as the DMA would hand them over
+    proto_result = r;
+    proto_init(&p, bench_on_frame, NULL);
+    t0 = _DWT->CYCCNT;
+    for (uint32_t i = 0; i < len; ) {
+        uint32_t n = 1 + bench_rand() % 64;
+
+        if (n > len - i) {
+            n = len - i;
+        }
+        proto_feed(&p, proto_stream + i, n);
+        i += n;
+    }
+    r->cycles = _DWT->CYCCNT - t0;
+    r->crc_errors = p.stats.crc_errors;
+}
+
+/****************************************************************************
+ *  position analysis
+ ***************************************************************************/
+static void bench_analysis(BenchAnalyze *r) {
+    int8_t values[9];
+    Board b;
+    uint32_t t0;
+
+    ai_init();
+    for (uint32_t i = 0; i < AI_TABLE_SIZE; ++i) {
+        ai_board_from_index(i, &b);
+        t0 = _DWT->CYCCNT;
+        int n = ai_analyze(b, values);
+        if (n > 0) {
+            r->cycles += _DWT->CYCCNT - t0;
+            r->queries++;
+            r->moves += (uint32_t)n;
+        }
+    }
+}
+
+/****************************************************************************
+ *  sessions
+ ***************************************************************************/
+#define SESSION_MOVES   4096
+
+static void bench_session(BenchSession *r, uint32_t sessions) {
+    uint32_t t0;
+
+    session_init();
+    r->sessions = sessions;
+    t0 = _DWT->CYCCNT;
+    while (r->moves < SESSION_MOVES) {
+        Session *s = session_get(0, (uint16_t)(bench_rand() % sessions));
+        Board b = session_board(s);
+        uint32_t empty = ~(b.x | b.o) & AI_CELLS;
+        int row, col, k;
+
+        if (!empty || ai_check_win(b.o)) {
+            s->cells = SESSION_USED;    // game over: new game
+            continue;
+        }
+        // random player move
+        for (k = (int)(bench_rand() % 9); !(empty & (1u << k)); k = (k + 1) % 9) {}
+        b.x |= (uint16_t)(1u << k);
+        if (ai_check_win(b.x) || ai_play(b, &row, &col) == AI_NO_MOVE) {
+            s->cells = SESSION_USED;
+            continue;
+        }
+        b.o |= AI_CELL(row, col);
+        session_set_board(s, b);
+        r->moves++;
+    }
+    r->cycles = _DWT->CYCCNT - t0;
+    r->evicted = session_stats.evicted;
+}
+
+/****************************************************************************
+ *  formatted output
+ ***************************************************************************/
+// The formatter term.c used before lib/fmt.h, kept as it was but writing
+// to legacy_buf instead of the terminal
+static char legacy_buf[128];
+static uint32_t legacy_len;
+
+static void legacy_putc(char c) {
+    legacy_buf[legacy_len++] = c;
+}
+
+static void legacy_puts(const char *s) {
+    while (*s) {
+        legacy_putc(*s++);
+    }
+}
+
+// num2str
+//   convert a number 'number' in base 'base' to the string s (the string
+//   variable must be large enough)
+//   size : (unsigned int) minimal number of digit width for string number
+//   sp   : (boolean) complete the width with ' ' or '0'
+static void num2str(char *s, unsigned int number, unsigned int base, int size, int sp)
+{
+	static char  hexChars[] = "0123456789ABCDEF";
+
+	char *p=s;
+	int cnt;
+	int i;
+	char tmp;
+
+	// get digits
+	do {
+		*s++=hexChars[number % base];
+	} while (number /= base);
+	*s='\0';
+
+	// reverse string
+	cnt=s-p;
+	for (i=0;i<cnt/2;i++) {
+		tmp=p[i]; p[i] = p[cnt-i-1]; p[cnt-i-1]=tmp;
+	}
+
+	// add extra space
+	if (cnt<size) {
+		for (i=cnt;i>=0;i--) p[i+size-cnt]=p[i];
+		if (sp) tmp=' '; else tmp='0';
+		for (i=0;i<size-cnt;i++) p[i]=tmp;
+	}
+}
+
+static unsigned int str2num(char *s, unsigned base)
+{
+	unsigned int u=0, d;
+	char ch=*s++;
+	while (ch) {
+		if ((ch>='0') && (ch<='9')) d=ch-'0';
+		else if ((base==16) && (ch>='A') && (ch<='F')) d=ch-'A'+10;
+		else if ((base==16) && (ch>='a') && (ch<='f')) d=ch-'a'+10;
+		else break;
+		u=d+base*u;
+		ch=*s++;
+	}
+	return u;
+}
+
+static void legacy_printf(const char* fmt, ...)
+{
+	va_list        ap;
+	char          *p;
+	char           ch;
+	unsigned long  ul;
+	unsigned long  size;
+	unsigned int   sp;
+	char           s[34];
+	
+	va_start(ap, fmt);
+	while (*fmt != '\0') {
+		if (*fmt =='%') {
+			size=0; sp=1;
+			if (*++fmt=='0') {fmt++; sp=0;}	// parse %04d --> sp=0
+			ch=*fmt;
+			if ((ch>'0') && (ch<='9')) {	// parse %4d --> size=4
+				char tmp[10];
+				int i=0;
+				while ((ch>='0') && (ch<='9')) {
+					tmp[i++]=ch;
+					ch=*++fmt;
+				}
+				tmp[i]='\0';
+				size=str2num(tmp,10);
+			}
+			switch (ch) {
+				case '%':
+					legacy_putc('%');
+					break;
+				case 'c':
+					ch = (char)va_arg(ap, int);
+					legacy_putc(ch);
+					break;
+				case 's':
+					p = va_arg(ap, char *);
+					legacy_puts(p);
+					break;
+				case 'd':
+					ul = va_arg(ap, long);
+					if ((long)ul < 0) {
+						legacy_putc('-');
+						ul = -(long)ul;
+						size--;
+					}
+					num2str(s, ul, 10, size, sp);
+					legacy_puts(s);
+					break;
+				case 'u':
+					ul = va_arg(ap, unsigned int);
+					num2str(s, ul, 10, size, sp);
+					legacy_puts(s);
+					break;
+				case 'o':
+					ul = va_arg(ap, unsigned int);
+					num2str(s, ul, 8, size, sp);
+					legacy_puts(s);
+					break;
+				case 'p':
+					legacy_putc('0');
+					legacy_putc('x');
+					ul = va_arg(ap, unsigned int);
+					num2str(s, ul, 16, size, sp);
+					legacy_puts(s);
+					break;
+				case 'x':
+					ul = va_arg(ap, unsigned int);
+					num2str(s, ul, 16, size, sp);
+					legacy_puts(s);
+					break;
+				default:
+				    legacy_putc(*fmt);
+			}
+		} else legacy_putc(*fmt);
+		fmt++;
+	}
+	va_end(ap);
+}
+
+#define FMT_LINES   256
+
+static void bench_format(BenchFmt *r) {
+    char buf[128];
+    uint32_t t0;
+
+    for (uint32_t i = 0; i < FMT_LINES; ++i) {
+        uint32_t a = bench_rand(), b = bench_rand() >> (i % 32);
+        int d = (int)(bench_rand() % 2001) - 1000;
+
+        legacy_len = 0;
+        t0 = _DWT->CYCCNT;
+        legacy_printf("%s: %u positions, %u mismatches, %d, %04d\r\n", "reachable", (unsigned)a, (unsigned)b, d, (int)(i % 10000));
+        r->legacy_cycles += _DWT->CYCCNT - t0;
+        legacy_buf[legacy_len] = '\0';
+
+        t0 = _DWT->CYCCNT;
+        fmt_snprintf(buf, sizeof(buf), "%s: %u positions, %u mismatches, %d, %04d\r\n", "reachable", (unsigned)a, (unsigned)b, d, (int)(i % 10000));
+        r->fmt_cycles += _DWT->CYCCNT - t0;
+
+        r->lines++;
+        if (strcmp(buf, legacy_buf) != 0) {
+            r->mismatches++;
+        }
+    }
+}
+
+/****************************************************************************
+ *  LCD
+ ***************************************************************************/
+#define DISPLAY_UPDATES 64
+
+static void bench_lcd(BenchDisplay *r) {
+    uint32_t t0;
+
+    for (uint32_t i = 0; i < DISPLAY_UPDATES; ++i) {
+        uint32_t rnd = bench_rand();
+
+        t0 = _DWT->CYCCNT;
+        display_clear();
+        if (rnd % 8) {
+            display_printf(0, 0, "row = %d, col = %d", (int)(rnd / 8 % 3), (int)(rnd / 24 % 3));
+        } else {
+            display_text(0, 0, rnd & 8 ? "Oh no! I'm the winner!" : "Oops, I lose.");
+        }
+        r->bytes += display_flush();
+        r->cycles += _DWT->CYCCNT - t0;
+
+        t0 = _DWT->CYCCNT;
+        while (display_busy()) {}
+        r->transfer_cycles += _DWT->CYCCNT - t0;
+
+        t0 = _DWT->CYCCNT;
+        r->bytes += display_flush();
+        r->idle_cycles += _DWT->CYCCNT - t0;
+
+        r->updates++;
+        r->full_bytes += DISPLAY_PAGES * (3 + DISPLAY_WIDTH);
+    }
+
+    Board b = { 0, 0 };
+
+    display_clear();
+    board_view_draw(b);
+    display_flush();
+    while (display_busy()) {}
+    for (uint32_t i = 0; i < DISPLAY_UPDATES; ++i) {
+        uint32_t cell = AI_CELL(bench_rand() % 3, bench_rand() % 3);
+
+        if ((b.x | b.o) == AI_CELLS) {  // board full: start again
+            b.x = b.o = 0;
+            board_view_draw(b);
+        }
+        while ((b.x | b.o) & cell) {
+            cell = cell == AI_CELL(2, 2) ? AI_CELL(0, 0) : cell << 1;
+        }
+        if (i & 1) {
+            b.o = (uint16_t)(b.o | cell);
+        } else {
+            b.x = (uint16_t)(b.x | cell);
+        }
+
+        t0 = _DWT->CYCCNT;
+        board_view_update(b);
+        r->move_cycles += _DWT->CYCCNT - t0;
+        r->move_bytes += display_flush();
+        while (display_busy()) {}
+        r->moves++;
+    }
+}
+
+static void bench_print(const char *name, BenchSearch *r) {
+    term_printf("%s: %u positions, %u mismatches\r\n", name,
+                (unsigned)r->positions, (unsigned)r->mismatches);
+    term_printf("  legacy    : %u nodes, %u kcycles, %u cycles/node\r\n",
+                (unsigned)r->legacy_nodes, (unsigned)(r->legacy_cycles / 1000),
+                (unsigned)(r->legacy_cycles / r->legacy_nodes));
+    term_printf("  legacy int: %u nodes, %u kcycles, %u cycles/node\r\n",
+                (unsigned)r->legacy_nodes, (unsigned)(r->legacy_int_cycles / 1000),
+                (unsigned)(r->legacy_int_cycles / r->legacy_nodes));
+    term_printf("  ai        : %u nodes, %u kcycles, %u cycles/node\r\n",
+                (unsigned)r->ai_nodes, (unsigned)(r->ai_cycles / 1000),
+                (unsigned)(r->ai_cycles / r->ai_nodes));
+    term_printf("  tt        : %u hits, %u misses\r\n",
+                (unsigned)r->tt_hits, (unsigned)r->tt_misses);
+    term_printf("  table     : %u cycles/move, %u mismatches\r\n",
+                (unsigned)(r->table_cycles / r->positions), (unsigned)r->table_mismatches);
+}
+
+void bench_run(uint32_t baud) {
+    char b[3][3];
+    int pow3[9];
+
+    term_init(_USART2, baud, 24, 80);
+    cycles_init();
+
+    memset(b, ' ', sizeof(b));
+    memset(&bench_empty, 0, sizeof(bench_empty));
+    bench_position(b, &bench_empty);
+
+    memset(&bench_all, 0, sizeof(bench_all));
+    memset(seen, 0, sizeof(seen));
+    pow3[0] = 1;
+    for (int k = 1; k < 9; ++k) {
+        pow3[k] = pow3[k - 1] * 3;
+    }
+    bench_walk(b, 0, pow3, 'X');
+
+    memset(&bench_ring, 0, sizeof(bench_ring));
+    bench_rings(&bench_ring);
+
+    memset(&bench_proto, 0, sizeof(bench_proto));
+    bench_protocol(&bench_proto);
+
+    memset(&bench_analyze, 0, sizeof(bench_analyze));
+    bench_analysis(&bench_analyze);
+
+    memset(bench_sessions, 0, sizeof(bench_sessions));
+    bench_session(&bench_sessions[0], SESSION_MAX * 3 / 4);
+    bench_session(&bench_sessions[1], SESSION_MAX * 2);
+
+    memset(&bench_fmt, 0, sizeof(bench_fmt));
+    bench_format(&bench_fmt);
+
+    memset(&bench_display, 0, sizeof(bench_display));
+    bench_lcd(&bench_display);
+
+    bench_print("empty board", &bench_empty);
+    bench_print("reachable positions", &bench_all);
+    term_printf("ring: %u bytes, %u errors\r\n", (unsigned)bench_ring.bytes,
+                (unsigned)bench_ring.errors);
+    term_printf("  modulo    : %u cycles/kbyte\r\n",
+                (unsigned)(bench_ring.modulo_cycles * 1024 / bench_ring.bytes));
+    term_printf("  push/pop  : %u cycles/kbyte\r\n",
+                (unsigned)(bench_ring.byte_cycles * 1024 / bench_ring.bytes));
+    term_printf("  spans     : %u cycles/kbyte\r\n",
+                (unsigned)(bench_ring.span_cycles * 1024 / bench_ring.bytes));
+    term_printf("proto: %u bytes, %u/%u frames, %u corrupted, %u crc errors\r\n",
+                (unsigned)bench_proto.bytes, (unsigned)bench_proto.received,
+                (unsigned)bench_proto.frames, (unsigned)bench_proto.corrupted,
+                (unsigned)bench_proto.crc_errors);
+    term_printf("  parser    : %u cycles/kbyte\r\n",
+                (unsigned)(bench_proto.cycles * 1024 / bench_proto.bytes));
+    uint32_t per_query = (uint32_t)(bench_analyze.cycles / bench_analyze.queries);
+    term_printf("analyze: %u queries, %u moves, %u cycles/query, %u queries/s\r\n",
+                (unsigned)bench_analyze.queries, (unsigned)bench_analyze.moves,
+                (unsigned)per_query,
+                (unsigned)(per_query ? sysclks.ahb_freq / per_query : 0));
+    term_printf("format: %u lines, %u mismatches, legacy %u cycles/line, fmt %u cycles/line\r\n",
+                (unsigned)bench_fmt.lines, (unsigned)bench_fmt.mismatches,
+                (unsigned)(bench_fmt.legacy_cycles / bench_fmt.lines),
+                (unsigned)(bench_fmt.fmt_cycles / bench_fmt.lines));
+    term_printf("lcd: %u updates, %u bytes/update, full screen %u bytes/update\r\n",
+                (unsigned)bench_display.updates,
+                (unsigned)(bench_display.bytes / bench_display.updates),
+                (unsigned)(bench_display.full_bytes / bench_display.updates));
+    term_printf("  update    : %u cycles, then DMA %u cycles, idle flush %u cycles\r\n",
+                (unsigned)(bench_display.cycles / bench_display.updates),
+                (unsigned)(bench_display.transfer_cycles / bench_display.updates),
+                (unsigned)(bench_display.idle_cycles / bench_display.updates));
+    term_printf("  board     : %u moves, %u cycles/move, %u bytes/move\r\n",
+                (unsigned)bench_display.moves,
+                (unsigned)(bench_display.move_cycles / bench_display.moves),
+                (unsigned)(bench_display.move_bytes / bench_display.moves));
+    for (int i = 0; i < 2; ++i) {
+        BenchSession *r = &bench_sessions[i];
+        uint32_t per_move = (uint32_t)(r->cycles / r->moves);
+        term_printf("sessions: %u games, %u moves, %u evicted, %u cycles/move, %u moves/s\r\n",
+                    (unsigned)r->sessions, (unsigned)r->moves, (unsigned)r->evicted,
+                    (unsigned)per_move,
+                    (unsigned)(per_move ? sysclks.ahb_freq / per_move : 0));
+    }
+}
@@ -0,0 +1,119 @@
+#ifndef _BENCH_H_
+#define _BENCH_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/* Search benchmark result for one set of positions: the former plain
+ * minimax (legacy) against the current engine (ai). legacy_int is the
+ * same plain minimax with integer max/min instead of fmax/fmin, which
+ * visits exactly the same nodes.
+ */
+typedef struct {
+    uint32_t positions;         // positions searched
+    uint32_t mismatches;        // positions where both engines disagree
+    uint64_t legacy_nodes;
+    uint64_t ai_nodes;
+    uint64_t legacy_cycles;
+    uint64_t legacy_int_cycles;
+    uint64_t ai_cycles;
+    uint64_t table_cycles;      // move table lookups (src/ai_table.h)
+    uint32_t table_mismatches;  // lookups that disagree with the search
+    uint32_t tt_hits;           // transposition table probes (cold table)
+    uint32_t tt_misses;
+} BenchSearch;
+
+/* Ring benchmark: the same bytes sent through a 64 byte ring in bursts,
+ * with the former term.c ring ('%' on int indices), with ring_push and
+ * ring_pop (lib/ring.h), and with ring_write and ring_read (spans).
+ */
+typedef struct {
+    uint32_t bytes;             // bytes through each ring
+    uint32_t errors;            // bytes read back wrong
+    uint64_t modulo_cycles;
+    uint64_t byte_cycles;
+    uint64_t span_cycles;
+} BenchRing;
+
+/* Protocol benchmark: valid frames with random payloads between bursts
+ * of random bytes, fed to the parser in random chunks (src/proto.h).
+ */
+typedef struct {
+    uint32_t bytes;             // stream size
+    uint32_t frames;            // valid frames in the stream
+    uint32_t received;          // frames handed over by the parser
+    uint32_t corrupted;         // frames received with wrong contents
+    uint32_t crc_errors;        // noise rejected by the CRC
+    uint64_t cycles;            // parse time
+} BenchProto;
+
+/* Analysis benchmark: ai_analyze() on every legal unfinished board of
+ * the 3^9 base-3 indices, as the PROTO_C_ANALYZE3 command would.
+ */
+typedef struct {
+    uint32_t queries;
+    uint32_t moves;             // move values returned
+    uint64_t cycles;
+} BenchAnalyze;
+
+/* Session benchmark: random player moves and the AI replies, spread
+ * over 'sessions' games picked at random (src/session.h), with the
+ * lookups, evictions and ai_play() calls the command loop would make.
+ */
+typedef struct {
+    uint32_t sessions;
+    uint32_t moves;             // AI moves played
+    uint32_t evicted;
+    uint64_t cycles;
+} BenchSession;
+
+/* Formatted output benchmark: the same status lines formatted by the
+ * former term_printf (num2str) and by fmt_snprintf (lib/fmt.h).
+ */
+typedef struct {
+    uint32_t lines;
+    uint32_t mismatches;        // lines where both outputs differ
+    uint64_t legacy_cycles;
+    uint64_t fmt_cycles;
+} BenchFmt;
+
+/* LCD benchmark: the game texts drawn one after the other and flushed
+ * by page diff (src/display.h), each followed by a flush with nothing
+ * changed. full_bytes is what redrawing the whole screen each time
+ * would send. Then random moves on the board (src/board_view.h), one
+ * cell tile each, drawn and flushed.
+ */
+typedef struct {
+    uint32_t updates;
+    uint32_t bytes;             // bytes sent on SPI
+    uint32_t full_bytes;
+    uint64_t cycles;            // drawing and flush, until it returns
+    uint64_t transfer_cycles;   // then until the DMA is done
+    uint64_t idle_cycles;       // flushes with nothing changed
+    uint32_t moves;
+    uint32_t move_bytes;
+    uint64_t move_cycles;       // board_view_update(), one tile
+} BenchDisplay;
+
+extern BenchSearch bench_empty;     // AI to play on the empty board
+extern BenchSearch bench_all;       // every reachable position, AI to play
+extern BenchRing bench_ring;
+extern BenchProto bench_proto;
+extern BenchAnalyze bench_analyze;
+extern BenchSession bench_sessions[2]; // within SESSION_MAX, and twice it
+extern BenchFmt bench_fmt;
+extern BenchDisplay bench_display;
+
+/* bench_run
+ *   run the benchmarks (DWT cycle counter) and print a report on USART2,
+ *   at baud bauds
+ */
+void bench_run(uint32_t baud);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
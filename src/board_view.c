@@ -0,0 +1,104 @@
+#include "src/display.h"
+#include "src/board_view.h"
+
+// Bitmaps of lcd_128x32.h: rows of bytes, leftmost pixel in bit 7.
+// Bitmap.data is not const, the tiles are only read.
+static const uint8_t grid_data[] = {
+    0x00, 0x20, 0x04, 0x00,     // ..........#..........#..........
+    0x00, 0x20, 0x04, 0x00,     // ..........#..........#..........
+    0x00, 0x20, 0x04, 0x00,     // ..........#..........#..........
+    0x00, 0x20, 0x04, 0x00,     // ..........#..........#..........
+    0x00, 0x20, 0x04, 0x00,     // ..........#..........#..........
+    0x00, 0x20, 0x04, 0x00,     // ..........#..........#..........
+    0x00, 0x20, 0x04, 0x00,     // ..........#..........#..........
+    0x00, 0x20, 0x04, 0x00,     // ..........#..........#..........
+    0x00, 0x20, 0x04, 0x00,     // ..........#..........#..........
+    0x00, 0x20, 0x04, 0x00,     // ..........#..........#..........
+    0xFF, 0xFF, 0xFF, 0xFF,     // ################################
+    0x00, 0x20, 0x04, 0x00,     // ..........#..........#..........
+    0x00, 0x20, 0x04, 0x00,     // ..........#..........#..........
+    0x00, 0x20, 0x04, 0x00,     // ..........#..........#..........
+    0x00, 0x20, 0x04, 0x00,     // ..........#..........#..........
+    0x00, 0x20, 0x04, 0x00,     // ..........#..........#..........
+    0x00, 0x20, 0x04, 0x00,     // ..........#..........#..........
+    0x00, 0x20, 0x04, 0x00,     // ..........#..........#..........
+    0x00, 0x20, 0x04, 0x00,     // ..........#..........#..........
+    0x00, 0x20, 0x04, 0x00,     // ..........#..........#..........
+    0x00, 0x20, 0x04, 0x00,     // ..........#..........#..........
+    0xFF, 0xFF, 0xFF, 0xFF,     // ################################
+    0x00, 0x20, 0x04, 0x00,     // ..........#..........#..........
+    0x00, 0x20, 0x04, 0x00,     // ..........#..........#..........
+    0x00, 0x20, 0x04, 0x00,     // ..........#..........#..........
+    0x00, 0x20, 0x04, 0x00,     // ..........#..........#..........
+    0x00, 0x20, 0x04, 0x00,     // ..........#..........#..........
+    0x00, 0x20, 0x04, 0x00,     // ..........#..........#..........
+    0x00, 0x20, 0x04, 0x00,     // ..........#..........#..........
+    0x00, 0x20, 0x04, 0x00,     // ..........#..........#..........
+    0x00, 0x20, 0x04, 0x00,     // ..........#..........#..........
+    0x00, 0x20, 0x04, 0x00,     // ..........#..........#..........
+};
+
+static const uint8_t empty_data[2 * BOARD_VIEW_CELL];
+
+static const uint8_t x_data[] = {
+    0x00, 0x00,                 // ..........
+    0x61, 0x80,                 // .##....##.
+    0x73, 0x80,                 // .###..###.
+    0x3F, 0x00,                 // ..######..
+    0x1E, 0x00,                 // ...####...
+    0x1E, 0x00,                 // ...####...
+    0x3F, 0x00,                 // ..######..
+    0x73, 0x80,                 // .###..###.
+    0x61, 0x80,                 // .##....##.
+    0x00, 0x00,                 // ..........
+};
+
+static const uint8_t o_data[] = {
+    0x00, 0x00,                 // ..........
+    0x1E, 0x00,                 // ...####...
+    0x33, 0x00,                 // ..##..##..
+    0x61, 0x80,                 // .##....##.
+    0x40, 0x80,                 // .#......#.
+    0x40, 0x80,                 // .#......#.
+    0x61, 0x80,                 // .##....##.
+    0x33, 0x00,                 // ..##..##..
+    0x1E, 0x00,                 // ...####...
+    0x00, 0x00,                 // ..........
+};
+
+static const Bitmap grid = { BOARD_VIEW_SIZE, BOARD_VIEW_SIZE, 4, (uint8_t *)grid_data };
+static const Bitmap tiles[3] = {    // empty, X (player), O (AI)
+    { BOARD_VIEW_CELL, BOARD_VIEW_CELL, 2, (uint8_t *)empty_data },
+    { BOARD_VIEW_CELL, BOARD_VIEW_CELL, 2, (uint8_t *)x_data },
+    { BOARD_VIEW_CELL, BOARD_VIEW_CELL, 2, (uint8_t *)o_data },
+};
+
+static Board shown;                 // last board drawn
+
+static void draw_cell(Board b, int i) {
+    const Bitmap *t = &tiles[(b.x >> i & 1) ? 1 : (b.o >> i & 1) ? 2 : 0];
+
+    display_bitmap(t, i % 3 * BOARD_VIEW_PITCH, i / 3 * BOARD_VIEW_PITCH);
+}
+
+void board_view_draw(Board b) {
+    display_bitmap(&grid, 0, 0);
+    for (int i = 0; i < 9; ++i) {
+        draw_cell(b, i);
+    }
+    shown = b;
+}
+
+int board_view_update(Board b) {
+    uint32_t changed = (uint32_t)((b.x ^ shown.x) | (b.o ^ shown.o)) & AI_CELLS;
+    int n = 0;
+
+    for (int i = 0; changed; ++i, changed >>= 1) {
+        if (changed & 1) {
+            draw_cell(b, i);
+            n++;
+        }
+    }
+    shown = b;
+    return n;
+}
@@ -0,0 +1,33 @@
+#ifndef _BOARD_VIEW_H_
+#define _BOARD_VIEW_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "src/ai.h"
+
+/* The game board on the LCD (src/display.h): a 32x32 grid at the left of
+ * the screen, 10x10 cells 1 pixel apart. The grid and the X and O marks
+ * are const bitmaps drawn at build time, so a move costs the copy of one
+ * cell tile into the back buffer.
+ */
+#define BOARD_VIEW_SIZE     32      /* pixels, the board is square */
+#define BOARD_VIEW_CELL     10
+#define BOARD_VIEW_PITCH    (BOARD_VIEW_CELL + 1)
+
+/* board_view_draw
+ *   draw the grid and every cell of board b
+ */
+void board_view_draw(Board b);
+
+/* board_view_update
+ *   draw the cells of board b that differ from the last board drawn,
+ *   return their number
+ */
+int board_view_update(Board b);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
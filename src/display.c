@@ -0,0 +1,311 @@
+#include <stdarg.h>
+#include <string.h>
+#include "include/board.h"
+#include "lib/io.h"
+#include "lib/spi.h"
+#include "lib/dma.h"
+#include "lib/fmt.h"
+#include "src/display.h"
+#include "src/font.h"
+
+// ST7565 commands
+#define ST7565_PAGE         0xB0    // | page
+#define ST7565_COL_HI       0x10    // | column bits 7..4
+#define ST7565_COL_LO       0x00    // | column bits 3..0
+
+// SPI1 DMA requests: transmit on stream 3, receive on stream 0 (the
+// libstm32 spi_dma_write() uses stream 5, USART1 stream 2)
+#define DISPLAY_DMA         _DMA2
+#define DISPLAY_TX_STREAM   3
+#define DISPLAY_RX_STREAM   0
+#define DISPLAY_DMA_CHANNEL 3
+
+DisplayStats display_stats;
+
+static uint8_t back[DISPLAY_PAGES][DISPLAY_WIDTH];     // being drawn
+static uint8_t front[DISPLAY_PAGES][DISPLAY_WIDTH];    // on the panel
+static uint8_t dirty;                                   // pages drawn
+
+// Changed columns of a page, sent from front[] after the commands that
+// address them
+typedef struct {
+    uint8_t page;
+    uint8_t col;
+    uint8_t len;
+    uint8_t cmd[3];
+} Segment;
+
+static Segment segs[DISPLAY_PAGES];
+static uint32_t seg_count;
+static volatile uint32_t seg_next;      // segment being sent
+static volatile int seg_data;           // its data, not its commands
+static volatile int busy;
+static DMA_Stream_t *tx_dma, *rx_dma;   // NULL: blocking writes
+static uint8_t rx_sink;                 // bytes clocked in, unused
+
+static void display_rx_tc(uint32_t stream, uint32_t bufid);
+
+void display_init(void) {
+    memset(back, 0, sizeof(back));
+    memset(front, 0, sizeof(front));
+    memset(&display_stats, 0, sizeof(display_stats));
+    dirty = 0;
+    busy = 0;
+
+    // The end of a transfer is taken from the receive stream: the last
+    // byte comes in once its last clock is out, when A0 and CS may change
+    // (the transmit stream ends up to two bytes earlier)
+    if (!tx_dma) {
+        DMAEndPoint_t mem = { EP_MEM, NULL, NULL, -1, EP_AUTOINC | EP_FMT_BYTE };
+        DMAEndPoint_t spi_tx = { EP_SPI_TX, (void *)&_SPI1->DR, NULL, DISPLAY_DMA_CHANNEL, EP_FMT_BYTE };
+        DMAEndPoint_t spi_rx = { EP_SPI_RX, (void *)&_SPI1->DR, NULL, DISPLAY_DMA_CHANNEL, EP_FMT_BYTE };
+        DMAEndPoint_t sink = { EP_MEM, &rx_sink, NULL, -1, EP_FMT_BYTE };
+
+        rx_dma = dma_stream_init(DISPLAY_DMA, DISPLAY_RX_STREAM, &spi_rx, &sink, STRM_PRIO_LOW, display_rx_tc);
+        tx_dma = dma_stream_init(DISPLAY_DMA, DISPLAY_TX_STREAM, &mem, &spi_tx, STRM_PRIO_LOW, NULL);
+        if (rx_dma && tx_dma) {
+            _SPI1->CR2 |= SPI_CR2_RXDMAEN | SPI_CR2_TXDMAEN;
+        } else {
+            tx_dma = NULL;
+        }
+    }
+}
+
+void display_clear(void) {
+    memset(back, 0, sizeof(back));
+    dirty = (1u << DISPLAY_PAGES) - 1;
+}
+
+// Replace the rows of column x from row y in mask (up to 8, bit 0 at the
+// top) with bits. Unless y is a multiple of 8, they straddle two pages.
+static void put_column(int x, int y, uint8_t bits, uint8_t mask) {
+    int shift = y & 7;
+    int page = (y - shift) / 8;
+    uint16_t v = (uint16_t)((bits & mask) << shift);
+    uint16_t m = (uint16_t)(mask << shift);
+
+    if (x < 0 || x >= DISPLAY_WIDTH) {
+        return;
+    }
+    if (page >= 0 && page < DISPLAY_PAGES) {
+        back[page][x] = (uint8_t)((back[page][x] & ~m) | v);
+        dirty |= (uint8_t)(1u << page);
+    }
+    if (shift && page + 1 >= 0 && page + 1 < DISPLAY_PAGES) {
+        back[page + 1][x] = (uint8_t)((back[page + 1][x] & ~(m >> 8)) | v >> 8);
+        dirty |= (uint8_t)(1u << (page + 1));
+    }
+}
+
+void display_pixel(int x, int y, int color) {
+    if (x < 0 || x >= DISPLAY_WIDTH || y < 0 || y >= DISPLAY_HEIGHT) {
+        return;
+    }
+    if (color) {
+        back[y >> 3][x] |= (uint8_t)(1u << (y & 7));
+    } else {
+        back[y >> 3][x] &= (uint8_t)~(1u << (y & 7));
+    }
+    dirty |= (uint8_t)(1u << (y >> 3));
+}
+
+// A page byte at a time, masked to the rows within y0..y1
+void display_fillrect(int x0, int y0, int x1, int y1, int color) {
+    int t;
+
+    if (x0 > x1) { t = x0; x0 = x1; x1 = t; }
+    if (y0 > y1) { t = y0; y0 = y1; y1 = t; }
+    if (x0 < 0) x0 = 0;
+    if (y0 < 0) y0 = 0;
+    if (x1 >= DISPLAY_WIDTH) x1 = DISPLAY_WIDTH - 1;
+    if (y1 >= DISPLAY_HEIGHT) y1 = DISPLAY_HEIGHT - 1;
+    if (x0 > x1 || y0 > y1) {
+        return;
+    }
+
+    for (int p = y0 >> 3; p <= y1 >> 3; ++p) {
+        int top = y0 > p * 8 ? y0 - p * 8 : 0;
+        int bottom = y1 < p * 8 + 7 ? y1 - p * 8 : 7;
+        uint8_t m = (uint8_t)((0xFFu << top) & (0xFFu >> (7 - bottom)));
+
+        for (int x = x0; x <= x1; ++x) {
+            back[p][x] = color ? (uint8_t)(back[p][x] | m) : (uint8_t)(back[p][x] & ~m);
+        }
+        dirty |= (uint8_t)(1u << p);
+    }
+}
+
+void display_rect(int x0, int y0, int x1, int y1, int color) {
+    display_fillrect(x0, y0, x1, y0, color);
+    display_fillrect(x0, y1, x1, y1, color);
+    display_fillrect(x0, y0, x0, y1, color);
+    display_fillrect(x1, y0, x1, y1, color);
+}
+
+// Bresenham
+void display_line(int x0, int y0, int x1, int y1, int color) {
+    int dx = x1 > x0 ? x1 - x0 : x0 - x1, sx = x0 < x1 ? 1 : -1;
+    int dy = y1 > y0 ? y0 - y1 : y1 - y0, sy = y0 < y1 ? 1 : -1;
+    int err = dx + dy;
+
+    if (x0 == x1 || y0 == y1) {
+        display_fillrect(x0, y0, x1, y1, color);
+        return;
+    }
+    for (;;) {
+        int e2 = 2 * err;
+
+        display_pixel(x0, y0, color);
+        if (x0 == x1 && y0 == y1) {
+            break;
+        }
+        if (e2 >= dy) {
+            err += dy;
+            x0 += sx;
+        }
+        if (e2 <= dx) {
+            err += dx;
+            y0 += sy;
+        }
+    }
+}
+
+// A column of 8 rows at a time, written as a page byte (or two)
+void display_bitmap(const Bitmap *bm, int x, int y) {
+    for (uint32_t i = 0; i < bm->width; ++i) {
+        const uint8_t *p = bm->data + (i >> 3);
+        uint8_t bit = (uint8_t)(0x80u >> (i & 7));
+
+        for (uint32_t j = 0; j < bm->height; j += 8) {
+            uint32_t n = bm->height - j < 8 ? bm->height - j : 8;
+            uint8_t bits = 0;
+
+            for (uint32_t k = 0; k < n; ++k) {
+                if (p[(j + k) * bm->bytes_per_line] & bit) {
+                    bits |= (uint8_t)(1u << k);
+                }
+            }
+            put_column(x + (int)i, y + (int)j, bits, (uint8_t)(0xFFu >> (8 - n)));
+        }
+    }
+}
+
+int display_text(int x, int y, const char *s) {
+    for (; *s && x < DISPLAY_WIDTH; ++s, x += DISPLAY_CHAR_W) {
+        char c = *s;
+
+        if (c < FONT_FIRST || c > FONT_LAST) {
+            c = '?';
+        }
+        for (int i = 0; i < FONT_W; ++i) {
+            put_column(x + i, y, font5x7[c - FONT_FIRST][i], 0xFF);
+        }
+        put_column(x + 5, y, 0, 0xFF);
+    }
+    return x;
+}
+
+int display_printf(int x, int y, const char *fmt, ...) {
+    char text[DISPLAY_COLS + 1];
+    va_list ap;
+
+    va_start(ap, fmt);
+    fmt_vsnprintf(text, sizeof(text), fmt, ap);
+    va_end(ap);
+    return display_text(x, y, text);
+}
+
+// Send n bytes as commands (a0 = 0) or display data (a0 = 1)
+static void send(uint8_t *buf, uint16_t n, int a0) {
+    if (a0) {
+        io_set(LCD_A0_GPIO_PORT, LCD_A0_GPIO_PINS);
+    } else {
+        io_clear(LCD_A0_GPIO_PORT, LCD_A0_GPIO_PINS);
+    }
+    if (tx_dma) {
+        (void)_SPI1->DR;                // a byte left by a blocking write
+        (void)_SPI1->SR;                // would end the count early
+        dma_start(rx_dma, n);
+        tx_dma->M0AR = (uintptr_t)buf;
+        dma_start(tx_dma, n);
+    } else {
+        spi_write(_SPI1, buf, n);
+        display_rx_tc(DISPLAY_RX_STREAM, 0);
+    }
+}
+
+// commands or data of a segment sent (DMA interrupt): send its data, or
+// the commands of the next one
+static void display_rx_tc(uint32_t stream, uint32_t bufid) {
+    Segment *g = &segs[seg_next];
+
+    if (!seg_data) {
+        seg_data = 1;
+        send(&front[g->page][g->col], g->len, 1);
+    } else if (++seg_next < seg_count) {
+        seg_data = 0;
+        send(segs[seg_next].cmd, sizeof(g->cmd), 0);
+    } else {
+        io_set(LCD_CS_N_GPIO_PORT, LCD_CS_N_GPIO_PINS);
+        busy = 0;
+    }
+}
+
+uint32_t display_flush(void) {
+    uint32_t sent = 0;
+
+    if (!dirty) {
+        return 0;
+    }
+    if (busy) {                         // front[] is being sent
+        display_stats.deferred++;
+        return 0;
+    }
+
+    seg_count = 0;
+    for (int p = 0; p < DISPLAY_PAGES; ++p) {
+        const uint8_t *b = back[p];
+        uint8_t *f = front[p];
+        int first = 0, last = DISPLAY_WIDTH - 1;
+
+        if (!(dirty & (1u << p))) {
+            continue;
+        }
+        while (first < DISPLAY_WIDTH && b[first] == f[first]) {
+            first++;
+        }
+        if (first == DISPLAY_WIDTH) {
+            continue;                   // drawn again the same
+        }
+        while (b[last] == f[last]) {
+            last--;
+        }
+        memcpy(f + first, b + first, (size_t)(last - first + 1));
+        segs[seg_count++] = (Segment){
+            (uint8_t)p, (uint8_t)first, (uint8_t)(last - first + 1),
+            { (uint8_t)(ST7565_PAGE | p),
+              (uint8_t)(ST7565_COL_HI | first >> 4),
+              (uint8_t)(ST7565_COL_LO | (first & 0x0F)) }
+        };
+        sent += 3 + (uint32_t)(last - first + 1);
+    }
+    dirty = 0;
+    if (!seg_count) {
+        return 0;
+    }
+
+    display_stats.frames++;
+    display_stats.pages += seg_count;
+    display_stats.bytes += sent;
+
+    busy = 1;
+    seg_next = 0;
+    seg_data = 0;
+    io_clear(LCD_CS_N_GPIO_PORT, LCD_CS_N_GPIO_PINS);
+    send(segs[0].cmd, sizeof(segs[0].cmd), 0);
+    return sent;
+}
+
+int display_busy(void) {
+    return busy;
+}
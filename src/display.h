@@ -0,0 +1,98 @@
+#ifndef _DISPLAY_H_
+#define _DISPLAY_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "libshield/lcd_128x32.h"
+
+/* 128x32 LCD of the mbed application shield (ST7565 on SPI1).
+ *
+ * Drawing goes to a back buffer in RAM, laid out like the controller
+ * memory: 4 pages of 8 rows, one byte per column, bit 0 at the top.
+ * display_flush() compares the pages drawn since the last flush with the
+ * front buffer, what the panel shows, copies the changed columns to it
+ * and hands them to the SPI DMA, a page after the other, then returns.
+ * An unchanged screen costs nothing and a new text a few dozen bytes,
+ * and the next frame can be drawn while the panel is being updated.
+ *
+ * The panel is set up by lcd_reset() (libshield); once display_init()
+ * is called, the libshield drawing functions must not be used any more.
+ */
+#define DISPLAY_WIDTH       128
+#define DISPLAY_HEIGHT      32
+#define DISPLAY_PAGES       (DISPLAY_HEIGHT / 8)
+
+#define DISPLAY_CHAR_W      6       /* 5x7 font, 1 column and 1 row apart */
+#define DISPLAY_CHAR_H      8
+#define DISPLAY_COLS        (DISPLAY_WIDTH / DISPLAY_CHAR_W)
+
+typedef struct {
+    uint32_t frames;            /* flushes that sent something */
+    uint32_t deferred;          /* flushes put off, transfer in progress */
+    uint32_t pages;             /* pages updated */
+    uint32_t bytes;             /* bytes sent on SPI, commands included */
+} DisplayStats;
+
+extern DisplayStats display_stats;
+
+/* display_init
+ *   blank buffers, the panel being blank (lcd_reset() then cls()), and
+ *   set up the SPI1 transmit DMA (DMA2 stream 3)
+ */
+void display_init(void);
+
+/* display_clear
+ *   clear the back buffer
+ */
+void display_clear(void);
+
+/* display_pixel
+ *   set (color 1) or clear (color 0) pixel (x, y)
+ */
+void display_pixel(int x, int y, int color);
+
+/* display_line, display_rect, display_fillrect
+ *   line, rectangle outline and filled rectangle from (x0, y0) to
+ *   (x1, y1) included, clipped to the screen
+ */
+void display_line(int x0, int y0, int x1, int y1, int color);
+void display_rect(int x0, int y0, int x1, int y1, int color);
+void display_fillrect(int x0, int y0, int x1, int y1, int color);
+
+/* display_bitmap
+ *   copy bitmap bm (rows of bytes, leftmost pixel in bit 7) with its top
+ *   left corner at (x, y), clear bits included
+ */
+void display_bitmap(const Bitmap *bm, int x, int y);
+
+/* display_text
+ *   draw string s with its top left corner at pixel (x, y), clipped to
+ *   the screen, return the x of the next character
+ */
+int display_text(int x, int y, const char *s);
+
+/* display_printf
+ *   display_text() of a formatted string (lib/fmt.h), DISPLAY_COLS
+ *   characters at most
+ */
+int display_printf(int x, int y, const char *fmt, ...);
+
+/* display_flush
+ *   start sending the columns that changed since the last flush, return
+ *   the number of bytes queued: 0 if there are none, or if a transfer is
+ *   still in progress (the drawing is kept for the next flush)
+ */
+uint32_t display_flush(void);
+
+/* display_busy
+ *   1 while a flush is being sent
+ */
+int display_busy(void);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
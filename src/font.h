@@ -0,0 +1,20 @@
+#ifndef _FONT_H_
+#define _FONT_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/* 5x7 font of the LCD text, ' ' to '~' */
+#define FONT_FIRST  ' '
+#define FONT_LAST   '~'
+#define FONT_W      5
+
+extern const uint8_t font5x7[FONT_LAST - FONT_FIRST + 1][FONT_W];
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -5,21 +5,112 @@
 #include "lib/timer.h"
 #include "libshield/libshield.h"
 #include "lib/uart.h"
+#include "lib/ring.h"
+#include "src/ai.h"
+#include "src/ai_table.h"
+#include "src/ponder.h"
+#include "src/proto.h"
+#include "src/session.h"
+#include "src/display.h"
+#include "src/board_view.h"
+#ifdef GAME_TERM
+#include "lib/fmt.h"
+#include "lib/term.h"
+#include "src/term_view.h"
+#endif
+#ifdef AI_BENCH
+#include "src/bench.h"
+#endif
 
 #define TIC_TAC_TOE
 
+#ifndef GAME_BAUD
+#define GAME_BAUD   115200      // make baud=N
+#endif
+
 #ifdef TIC_TAC_TOE 
 
-static char ticTacToe[3][3] = {
-  {' ', ' ', ' '},
-  {' ', ' ', ' '},
-  {' ', ' ', ' '}
-};
+// Game of the commands being run, see src/session.h
+static uint16_t game_id = 0;
+static Session *game = NULL;    // session_get(game_id), fetched on first use
 
-static int row_r = 0, col_r = 0;  // Global variables to store row and column we receive from the python client
+// Last game event, shown on the LCD
 static int row_s = 0, col_s = 0 ; // Global variables to store row and column we send to python cliente
-static int game_over = 0;
-static int winner = 0;
+static Session lcd_game;        // copy of the last game changed: its board,
+                                // SESSION_OVER and SESSION_WON
+// Bumped on each change of the above: the LCD is drawn again only when
+// it differs from lcd_shown
+static uint32_t lcd_version = 1, lcd_shown = 0;
+#ifdef GAME_TERM
+static uint32_t term_shown = 0;  // same for the terminal
+#endif
+
+// One game endpoint per serial port. The RX interrupt queues the bytes
+// in cmd_queue; the main loop parses them, runs the commands on the
+// shared engine and sends the replies.
+typedef struct {
+    USART_t      *uart;
+    OnUartRxSpan rx;                        // RX interrupt of the port
+    char         rx_dma[128];               // receive DMA buffer, handed
+                                            // over a burst at a time
+    char         cmd_data[512];             // power of 2, a few frames
+    Ring         cmd_queue;
+    volatile uint32_t cmd_overruns;         // bytes dropped, queue full
+    ProtoParser  parser;
+    // Frames sent by DMA. One more buffer than DMA requests can be queued:
+    // when the queue is full, the buffer being filled is not in flight.
+    uint8_t      frames[UART_TX_QUEUE + 1][PROTO_FRAME_MAX];
+    uint32_t     frame_idx;
+    uint32_t     pending;                   // size of frames[frame_idx],
+                                            // waiting for the queue, or 0
+    uint32_t     tx_dropped;                // frames dropped, one pending
+    // Last reply, sent again if the host repeats the frame
+    uint8_t      last_reply[PROTO_MAX_PAYLOAD];
+    uint32_t     last_len;
+    int          last_seq;
+} Port;
+
+static void ft_rx1(const char *buf, uint32_t len);
+static void ft_rx2(const char *buf, uint32_t len);
+static void ft_rx6(const char *buf, uint32_t len);
+
+static Port ports[] = {
+    { .uart = _USART1, .rx = ft_rx1 },
+    { .uart = _USART2, .rx = ft_rx2 },
+    { .uart = _USART6, .rx = ft_rx6 },
+};
+
+#define NB_PORTS    (sizeof(ports) / sizeof(ports[0]))
+
+static Port *port;              // port whose commands are being run
+
+// Queue the pending frame of port p for DMA, return 0 once it is
+static int send_pending(Port *p) {
+    const uint8_t *f = p->frames[p->frame_idx % (UART_TX_QUEUE + 1)];
+
+    if (p->pending) {
+        if (uart_write_async(p->uart, (const char *)f, p->pending, NULL) < 0) {
+            return -1;          // queue full: the link is slow or stalled
+        }
+        p->frame_idx++;
+        p->pending = 0;
+    }
+    return 0;
+}
+
+// Send a frame on port p without waiting for the serial link. If the DMA
+// queue is full, the frame waits and port_serve() sends it before taking
+// more commands from p. A frame sent while one waits is dropped: the host
+// repeats a command left without reply (or a CRC error without NAK).
+static void send_frame(Port *p, uint8_t type, uint8_t seq, const uint8_t *payload, uint32_t len) {
+    if (p->pending) {
+        p->tx_dropped++;
+        return;
+    }
+    p->pending = proto_frame(p->frames[p->frame_idx % (UART_TX_QUEUE + 1)],
+                             type, seq, payload, len);
+    send_pending(p);
+}
 
 unsigned int my_rand() {
     static unsigned int my_rand_state = 12345; // Initial seed for random number generator
@@ -27,174 +118,332 @@ unsigned int my_rand() {
     return my_rand_state % 3;
 }
 
-int check_win(char player) {
-    for (int i = 0; i < 3; ++i) {
-        if ((ticTacToe[i][0] == player && ticTacToe[i][1] == player && ticTacToe[i][2] == player) ||
-            (ticTacToe[0][i] == player && ticTacToe[1][i] == player && ticTacToe[2][i] == player)) {
-            return 1;
+// Show session s: the game that changed last
+static void lcd_show(const Session *s) {
+    lcd_game = *s;
+    lcd_version++;
+}
+
+// Board on the left, last move or result on the right
+#define LCD_TEXT_X  (BOARD_VIEW_SIZE + 4)
+#define LCD_TEXT_Y  12
+
+void lcd_affichage(void) {
+    if (lcd_shown != lcd_version) {
+        lcd_shown = lcd_version;
+        board_view_update(session_board(&lcd_game));
+        display_fillrect(LCD_TEXT_X, 0, DISPLAY_WIDTH - 1, DISPLAY_HEIGHT - 1, 0);
+        if (!(lcd_game.cells & SESSION_OVER)) {
+            display_printf(LCD_TEXT_X, LCD_TEXT_Y, "AI: row %d col %d", row_s, col_s);
+        } else if (lcd_game.cells & SESSION_WON) {
+            display_text(LCD_TEXT_X, LCD_TEXT_Y, "I'm the winner!");
+        } else {
+            display_text(LCD_TEXT_X, LCD_TEXT_Y, "Oops, I lose.");
         }
     }
+    display_flush();            // returns at once, the DMA does the rest
+}
 
-    if ((ticTacToe[0][0] == player && ticTacToe[1][1] == player && ticTacToe[2][2] == player) ||
-        (ticTacToe[0][2] == player && ticTacToe[1][1] == player && ticTacToe[2][0] == player)) {
-        return 1;
-    }
+#ifdef GAME_TERM
+// The same on the terminal of USART2 (make term=1)
+#define TERM_PORT   _USART2
 
-    return 0;
-}
+void term_affichage(void) {
+    char status[TERM_VIEW_STATUS_W + 1];
 
-int check_draw() {
-    for (int i = 0; i < 3; ++i) {
-        for (int j = 0; j < 3; ++j) {
-            if (ticTacToe[i][j] == ' ') {
-                return 0;
-            }
-        }
+    if (term_shown == lcd_version) {
+        return;
+    }
+    term_shown = lcd_version;
+    if (!(lcd_game.cells & SESSION_OVER)) {
+        fmt_snprintf(status, sizeof(status), "AI: row %d col %d", row_s, col_s);
+    } else {
+        fmt_snprintf(status, sizeof(status), "%s",
+                     (lcd_game.cells & SESSION_WON) ? "I'm the winner!" : "Oops, I lose.");
     }
-    return 1;
+    term_view_draw(session_board(&lcd_game), status);
 }
+#endif
 
-int evaluate_board() {
-    if (check_win('X')) {
-        return -1; // Player X wins
-    } else if (check_win('O')) {
-        return 1; // Player O wins
-    } else if (check_draw()) {
-        return 0; // Draw
-    } else {
-        return -2; // Game is still ongoing
+
+// RX interrupt: queue the bytes and return
+static void port_rx(Port *p, const char *buf, uint32_t len) {
+    uint32_t n = ring_write(&p->cmd_queue, buf, len);
+
+    p->cmd_overruns += len - n;
+    if (n) {
+        ai_stop = 1;    // input first: stop pondering
     }
 }
 
-int minimax(int depth, int is_maximizer) {
-    int score = evaluate_board();
+static void ft_rx1(const char *buf, uint32_t len) { port_rx(&ports[0], buf, len); }
+static void ft_rx2(const char *buf, uint32_t len) { port_rx(&ports[1], buf, len); }
+static void ft_rx6(const char *buf, uint32_t len) { port_rx(&ports[2], buf, len); }
+
+// Largest result of a command, and room kept for a final status
+#define REPLY_MAX   10
+#define STATUS_LEN  2
 
-    if (score != -2) {
-        return score;
+static void put_status(uint8_t *reply, uint32_t *len, uint8_t status) {
+    proto_put(reply, len, PROTO_MAX_PAYLOAD, PROTO_C_STATUS, &status);
+}
+
+static Session *game_session(void) {
+    if (!game) {
+        game = session_get((uint8_t)(port - ports), game_id);
     }
+    return game;
+}
 
-    if (depth == 9) {
-        return 0; // Maximum depth reached, return neutral score
+// Player move: play the AI reply, pondered if possible
+static void game_move(const uint8_t *args, uint8_t *reply, uint32_t *len) {
+    Session *s = game_session();
+    Board b = session_board(s);
+    int row = args[0], col = args[1];
+
+    if (row > 2 || col > 2 || ((b.x | b.o) & AI_CELL(row, col))) {
+        put_status(reply, len, PROTO_S_ILLEGAL);
+        return;
     }
+    if (s->cells & SESSION_OVER) {
+        put_status(reply, len, PROTO_S_OVER);
+        return;
+    }
+    b.x |= AI_CELL(row, col);
 
-    if (is_maximizer) {
-        int best_score = -1000;
-        for (int i = 0; i < 3; ++i) {
-            for (int j = 0; j < 3; ++j) {
-                if (ticTacToe[i][j] == ' ') {
-                    ticTacToe[i][j] = 'O'; // AI's move
-                    best_score = fmax(best_score, minimax(depth + 1, !is_maximizer));
-                    ticTacToe[i][j] = ' '; // Undo move
-                }
-            }
-        }
-        return best_score;
-    } else {
-        int best_score = 1000;
-        for (int i = 0; i < 3; ++i) {
-            for (int j = 0; j < 3; ++j) {
-                if (ticTacToe[i][j] == ' ') {
-                    ticTacToe[i][j] = 'X'; // Player's move
-                    best_score = fmin(best_score, minimax(depth + 1, !is_maximizer));
-                    ticTacToe[i][j] = ' '; // Undo move
-                }
-            }
-        }
-        return best_score;
+    int bestRow, bestCol;
+    int score = ponder_probe(b, &bestRow, &bestCol);
+    if (score == AI_NOT_FOUND) {
+        score = ai_play(b, &bestRow, &bestCol);
+    }
+    if (score == AI_NO_MOVE) {
+        session_set_board(s, b);
+        lcd_show(s);
+        put_status(reply, len, PROTO_S_OVER);
+        return;
     }
+    b.o |= AI_CELL(bestRow, bestCol); // Place the AI move
+    session_set_board(s, b);
+    row_s = bestRow;
+    col_s = bestCol;
+    lcd_show(s);
+    ponder_start(b);
+
+    uint8_t play[3] = { (uint8_t)bestRow, (uint8_t)bestCol, (uint8_t)score };
+    proto_put(reply, len, PROTO_MAX_PAYLOAD, PROTO_C_PLAY, play);
 }
 
+// Analysis queries answered, and the cycles they took (PROTO_C_STATS)
+static uint32_t analyze_queries = 0;
+static uint32_t analyze_cycles = 0;
+
+// Value of every move on board b, the game is left alone
+static void analyze(Board b, uint8_t *reply, uint32_t *len) {
+    int8_t values[9];
+    uint32_t t0 = _DWT->CYCCNT;
 
-void lcd_affichage_char(char c) {
-    lcd_printf("%c", c);
+    if (ai_analyze(b, values) < 0) {
+        put_status(reply, len, PROTO_S_ILLEGAL);
+        return;
+    }
+    analyze_cycles += _DWT->CYCCNT - t0;
+    analyze_queries++;
+    proto_put(reply, len, PROTO_MAX_PAYLOAD, PROTO_C_VALUES, (const uint8_t *)values);
 }
 
-void lcd_affichage() {
-    cls();
-    if (!game_over) {
-        lcd_printf("row = %d, col = %d", row_s, col_s);
-    } else {
-        if (winner) {
-            lcd_printf("Oh no! I'm the winner!");
-        } else {
-            lcd_printf("Oops, I lose.");
+static void put_u32(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static void game_cmd(int op, const uint8_t *args, uint8_t *reply, uint32_t *len) {
+    Board b;
+
+    switch (op) {
+    case PROTO_C_SESSION:
+        game_id = (uint16_t)(args[0] | args[1] << 8);
+        game = NULL;
+        break;
+    case PROTO_C_NEW:
+        game_session()->cells = SESSION_USED;
+        lcd_show(game);
+        ponder_start(session_board(game));
+        break;
+    case PROTO_C_MOVE:
+        game_move(args, reply, len);
+        break;
+    case PROTO_C_BOARD: {
+        b.x = (uint16_t)(args[0] | args[1] << 8);
+        b.o = (uint16_t)(args[2] | args[3] << 8);
+        int nx = __builtin_popcount(b.x), no = __builtin_popcount(b.o);
+        int won = ai_check_win(b.o);
+        int over = won || ai_check_win(b.x) || (b.x | b.o) == AI_CELLS;
+
+        // counts as in ai_analyze, and X to play unless the game is over:
+        // the next MOVE is an X
+        if ((b.x & b.o) || ((b.x | b.o) & ~AI_CELLS) || nx < no || nx > no + 1 ||
+            (nx > no && !over)) {
+            put_status(reply, len, PROTO_S_ILLEGAL);
+            break;
         }
+        game_session()->cells = SESSION_USED |
+                                (over ? SESSION_OVER : 0) | (won ? SESSION_WON : 0);
+        session_set_board(game, b);
+        lcd_show(game);
+        if (!over) {
+            ponder_start(b);
+        }
+        break;
     }
-}
+    case PROTO_C_GET: {
+        Session *s = game_session();
+        b = session_board(s);
+        uint8_t state[5] = {
+            (uint8_t)b.x, (uint8_t)(b.x >> 8),
+            (uint8_t)b.o, (uint8_t)(b.o >> 8),
+            (uint8_t)((s->cells & SESSION_OVER ? PROTO_STATE_OVER : 0) |
+                      (s->cells & SESSION_WON ? PROTO_STATE_WON : 0))
+        };
+        proto_put(reply, len, PROTO_MAX_PAYLOAD, PROTO_C_STATE, state);
+        break;
+    }
+    case PROTO_C_END:
+        game_session()->cells |= SESSION_OVER | (args[0] == PROTO_END_WON ? SESSION_WON : 0);
+        lcd_show(game);
+        break;
+    case PROTO_C_ANALYZE:
+        b.x = (uint16_t)(args[0] | args[1] << 8);
+        b.o = (uint16_t)(args[2] | args[3] << 8);
+        analyze(b, reply, len);
+        break;
+    case PROTO_C_ANALYZE3:
+        if (ai_board_from_index((uint32_t)(args[0] | args[1] << 8), &b) < 0) {
+            put_status(reply, len, PROTO_S_ILLEGAL);
+            break;
+        }
+        analyze(b, reply, len);
+        break;
+    case PROTO_C_STATS: {
+        uint8_t counts[8];
 
+        put_u32(counts, analyze_queries);
+        put_u32(counts + 4, analyze_cycles);
+        proto_put(reply, len, PROTO_MAX_PAYLOAD, PROTO_C_COUNTS, counts);
+        break;
+    }
+    default:                    // results are not commands
+        put_status(reply, len, PROTO_S_BAD_CMD);
+        break;
+    }
+}
 
-void ft_cb(char c) {
+// Command frame from the host: run its commands, reply with the results
+static void ft_frame(const ProtoFrame *f) {
+    Port *p = port;
+    const uint8_t *args;
+    uint32_t pos = 0;
+    int op = 0;
 
-    // Handle special commands and invalid input
-    if (c == ',') {
-        return;
-    } else if (c == 'l') {
-        game_over = 1;
+    if (f->type != PROTO_F_CMD) {
         return;
-    } else if (c == 'w') {
-        game_over = 1;
-        winner = 1;
-        return;
-    } else if (c < '0' || c > '2') { // Invalid input
+    }
+    if (f->seq == p->last_seq) {    // our reply was lost: send it again
+        send_frame(p, PROTO_F_REPLY, f->seq, p->last_reply, p->last_len);
         return;
     }
 
-    // Process player move
-    if (row_r == 0) {
-        row_r = c - '0';
-    } else if (col_r == 0) {
-        col_r = c - '0';
-        if (ticTacToe[row_r][col_r] == ' ') {
-            ticTacToe[row_r][col_r] = 'X';
-
-            // Loop until the AI makes its move
-            while (ticTacToe[row_s][col_s] == ' ') {
-                // Find the best move for the AI
-                int bestScore = -1000;
-                int bestRow = -1;
-                int bestCol = -1;
-
-                for (int i = 0; i < 3; i++) {
-                    for (int j = 0; j < 3; j++) {
-                        if (ticTacToe[i][j] == ' ') {
-                            ticTacToe[i][j] = 'O';
-                            int score = minimax(0, 0);
-                            ticTacToe[i][j] = ' ';
-
-                            if (score > bestScore) {
-                                bestScore = score;
-                                bestRow = i;
-                                bestCol = j;
-                            }
-                        }
-                    }
-                }
-
-                if (bestRow != -1 && bestCol != -1) {
-                    ticTacToe[bestRow][bestCol] = 'O'; // Place the AI move
-                    row_s = bestRow;
-                    col_s = bestCol;
-                    char row_char = '0' + bestRow;
-                    char col_char = '0' + bestCol;
-                    uart_putc(_USART2, row_char);
-                    uart_putc(_USART2, ',');
-                    uart_putc(_USART2, col_char);
-                    break; // Exit the loop after AI's move
-                }
-            }
-        }
-        row_r = 0;
-        col_r = 0;
+    p->last_len = 0;
+    game_id = 0;
+    game = NULL;
+    while (p->last_len + REPLY_MAX + STATUS_LEN <= PROTO_MAX_PAYLOAD &&
+           (op = proto_cmd_next(f, &pos, &args)) > 0) {
+        game_cmd(op, args, p->last_reply, &p->last_len);
+    }
+    if (op < 0) {
+        put_status(p->last_reply, &p->last_len, PROTO_S_BAD_CMD);
+    } else if (pos < f->len) {
+        put_status(p->last_reply, &p->last_len, PROTO_S_FULL);
     }
+    p->last_seq = f->seq;
+    send_frame(p, PROTO_F_REPLY, f->seq, p->last_reply, p->last_len);
+}
+
+// Frame with a wrong CRC: ask the host to send it again
+static void ft_frame_error(uint8_t seq, uint8_t error) {
+    send_frame(port, PROTO_F_NAK, seq, &error, 1);
+}
+
+// Parse one span of the commands queued on port p, return 0 if none.
+// While a reply waits for the DMA queue, the commands wait in cmd_queue.
+static int port_serve(Port *p) {
+    const char *cmd;
+    uint32_t n;
+
+    if (send_pending(p) < 0) {
+        return 0;
+    }
+    n = ring_read_span(&p->cmd_queue, &cmd);
+
+    if (n) {
+        port = p;
+        proto_feed(&p->parser, (const uint8_t *)cmd, n);
+        ring_read_commit(&p->cmd_queue, n);
+    }
+    return n != 0;
 }
 
 
 int main() {
     lcd_reset();
     cls();
-    uart_init(_USART2, 115200, UART_8N1, ft_cb);
+    display_init();
+    ai_init();
+    ponder_init();
+    session_init();
+#ifdef AI_BENCH
+    bench_run(GAME_BAUD);
+#endif
+    display_clear();
+    board_view_draw(session_board(&lcd_game));
+    for (uint32_t i = 0; i < NB_PORTS; ++i) {
+        Port *p = &ports[i];
+
+        ring_init(&p->cmd_queue, p->cmd_data, sizeof(p->cmd_data));
+        proto_init(&p->parser, ft_frame, ft_frame_error);
+        p->last_seq = -1;
+#ifdef GAME_TERM
+        if (p->uart == TERM_PORT) {
+            continue;           // the terminal, not a game port
+        }
+#endif
+        if (uart_init(p->uart, GAME_BAUD, UART_8N1, NULL) < 0) {
+            continue;           // rate out of reach with this clock
+        }
+        uart_rx_dma(p->uart, p->rx_dma, sizeof(p->rx_dma), p->rx);
+    }
+#ifdef GAME_TERM
+    term_init(TERM_PORT, GAME_BAUD, TERM_SCREEN_ROWS, TERM_SCREEN_COLS);
+    term_view_init();
+#endif
     while (1) {
+        // Process the pending commands of all the ports in turn, a span
+        // each, then refresh the screen if the game changed. Any byte
+        // received after ai_stop is cleared aborts the pondering.
+        int busy;
+        ai_stop = 0;
+        do {
+            busy = 0;
+            for (uint32_t i = 0; i < NB_PORTS; ++i) {
+                busy |= port_serve(&ports[i]);
+            }
+        } while (busy);
         lcd_affichage();
+#ifdef GAME_TERM
+        term_affichage();
+#endif
+        ponder_step();
     }
     return 0;
 }
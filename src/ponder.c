@@ -0,0 +1,77 @@
+#include "include/board.h"
+#include "src/ai_table.h"
+#include "src/ponder.h"
+
+PonderStats ponder_stats;
+
+// Reply to each player move k on the pondered board
+static struct {
+    int8_t   score;             // AI_NOT_FOUND: not searched yet
+    uint8_t  cell;
+    uint32_t cycles;            // cost of the search
+} replies[9];
+
+static Board    base;           // board the player is about to move on
+static uint32_t todo = 0;       // player moves still to search
+
+void ponder_init(void) {
+    _CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    _DWT->CYCCNT = 0;
+    _DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+void ponder_start(Board b) {
+    base = b;
+    todo = 0;
+    for (int k = 0; k < 9; ++k) {
+        replies[k].score = AI_NOT_FOUND;
+    }
+    if (ai_mode == AI_MODE_SEARCH && !ai_check_win(b.o)) {
+        todo = ~(b.x | b.o) & AI_CELLS;
+    }
+}
+
+int ponder_step(void) {
+    int k, row = 0, col = 0, score;     // (0, 0) when AI_NO_MOVE
+    uint32_t t0;
+    Board b;
+
+    if (!todo) {
+        return 0;
+    }
+    k = __builtin_ctz(todo);
+    b.x = (uint16_t)(base.x | (1u << k));
+    b.o = base.o;
+
+    t0 = _DWT->CYCCNT;
+    score = ai_search(b, &row, &col, 1);
+    if (score == AI_ABORTED) {
+        ponder_stats.aborts++;
+        return 1;                   // retried on the next idle step
+    }
+    replies[k].cycles = _DWT->CYCCNT - t0;
+    replies[k].score = (int8_t)score;
+    replies[k].cell = (uint8_t)(row * 3 + col);
+    todo &= todo - 1;
+    return todo != 0;
+}
+
+int ponder_probe(Board b, int *row, int *col) {
+    uint32_t played = b.x & ~base.x;
+
+    if (ai_mode != AI_MODE_SEARCH || b.o != base.o ||
+        (base.x & ~b.x) || !played || (played & (played - 1))) {
+        return AI_NOT_FOUND;        // not a single player move from base
+    }
+
+    int k = __builtin_ctz(played);
+    if (replies[k].score == AI_NOT_FOUND) {
+        ponder_stats.misses++;
+        return AI_NOT_FOUND;
+    }
+    ponder_stats.hits++;
+    ponder_stats.saved_cycles += replies[k].cycles;
+    *row = replies[k].cell / 3;
+    *col = replies[k].cell % 3;
+    return replies[k].score;
+}
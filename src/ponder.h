@@ -0,0 +1,51 @@
+#ifndef _PONDER_H_
+#define _PONDER_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "src/ai.h"
+
+/* Pondering: while waiting for the player, search the AI reply to every
+ * move the player can make, so that the actual reply costs a lookup.
+ * Only with AI_MODE_SEARCH (make ai=search): in the default AI_MODE_TABLE
+ * a reply already costs a table lookup, and AI_MODE_VERIFY has to check
+ * every table move against a search made then.
+ */
+typedef struct {
+    uint32_t hits;              /* replies served from the cache */
+    uint32_t misses;            /* player moves not pondered yet */
+    uint32_t aborts;            /* ponder searches stopped by input */
+    uint32_t saved_cycles;      /* search cycles spent in advance on hits */
+} PonderStats;
+
+extern PonderStats ponder_stats;
+
+/* ponder_init
+ *   start the cycle counter used for the statistics
+ */
+void ponder_init(void);
+
+/* ponder_start
+ *   the AI has just played on board b: drop the cache, ponder on b next
+ */
+void ponder_start(Board b);
+
+/* ponder_step
+ *   search the reply to one more player move, abortable with ai_stop.
+ *   Return 0 when every reply is known (nothing left to do).
+ */
+int ponder_step(void);
+
+/* ponder_probe
+ *   reply to board b (the pondered board plus the player move), from the
+ *   cache: same result as ai_play(), or AI_NOT_FOUND
+ */
+int ponder_probe(Board b, int *row, int *col);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,240 @@
+#include <string.h>
+#include "src/proto.h"
+
+// CRC-16/CCITT, one entry per byte value
+static const uint16_t crc_table[256] = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+    0x1231, 0x0210, 0x3273, 0x2252, 0x52B5, 0x4294, 0x72F7, 0x62D6,
+    0x9339, 0x8318, 0xB37B, 0xA35A, 0xD3BD, 0xC39C, 0xF3FF, 0xE3DE,
+    0x2462, 0x3443, 0x0420, 0x1401, 0x64E6, 0x74C7, 0x44A4, 0x5485,
+    0xA56A, 0xB54B, 0x8528, 0x9509, 0xE5EE, 0xF5CF, 0xC5AC, 0xD58D,
+    0x3653, 0x2672, 0x1611, 0x0630, 0x76D7, 0x66F6, 0x5695, 0x46B4,
+    0xB75B, 0xA77A, 0x9719, 0x8738, 0xF7DF, 0xE7FE, 0xD79D, 0xC7BC,
+    0x48C4, 0x58E5, 0x6886, 0x78A7, 0x0840, 0x1861, 0x2802, 0x3823,
+    0xC9CC, 0xD9ED, 0xE98E, 0xF9AF, 0x8948, 0x9969, 0xA90A, 0xB92B,
+    0x5AF5, 0x4AD4, 0x7AB7, 0x6A96, 0x1A71, 0x0A50, 0x3A33, 0x2A12,
+    0xDBFD, 0xCBDC, 0xFBBF, 0xEB9E, 0x9B79, 0x8B58, 0xBB3B, 0xAB1A,
+    0x6CA6, 0x7C87, 0x4CE4, 0x5CC5, 0x2C22, 0x3C03, 0x0C60, 0x1C41,
+    0xEDAE, 0xFD8F, 0xCDEC, 0xDDCD, 0xAD2A, 0xBD0B, 0x8D68, 0x9D49,
+    0x7E97, 0x6EB6, 0x5ED5, 0x4EF4, 0x3E13, 0x2E32, 0x1E51, 0x0E70,
+    0xFF9F, 0xEFBE, 0xDFDD, 0xCFFC, 0xBF1B, 0xAF3A, 0x9F59, 0x8F78,
+    0x9188, 0x81A9, 0xB1CA, 0xA1EB, 0xD10C, 0xC12D, 0xF14E, 0xE16F,
+    0x1080, 0x00A1, 0x30C2, 0x20E3, 0x5004, 0x4025, 0x7046, 0x6067,
+    0x83B9, 0x9398, 0xA3FB, 0xB3DA, 0xC33D, 0xD31C, 0xE37F, 0xF35E,
+    0x02B1, 0x1290, 0x22F3, 0x32D2, 0x4235, 0x5214, 0x6277, 0x7256,
+    0xB5EA, 0xA5CB, 0x95A8, 0x8589, 0xF56E, 0xE54F, 0xD52C, 0xC50D,
+    0x34E2, 0x24C3, 0x14A0, 0x0481, 0x7466, 0x6447, 0x5424, 0x4405,
+    0xA7DB, 0xB7FA, 0x8799, 0x97B8, 0xE75F, 0xF77E, 0xC71D, 0xD73C,
+    0x26D3, 0x36F2, 0x0691, 0x16B0, 0x6657, 0x7676, 0x4615, 0x5634,
+    0xD94C, 0xC96D, 0xF90E, 0xE92F, 0x99C8, 0x89E9, 0xB98A, 0xA9AB,
+    0x5844, 0x4865, 0x7806, 0x6827, 0x18C0, 0x08E1, 0x3882, 0x28A3,
+    0xCB7D, 0xDB5C, 0xEB3F, 0xFB1E, 0x8BF9, 0x9BD8, 0xABBB, 0xBB9A,
+    0x4A75, 0x5A54, 0x6A37, 0x7A16, 0x0AF1, 0x1AD0, 0x2AB3, 0x3A92,
+    0xFD2E, 0xED0F, 0xDD6C, 0xCD4D, 0xBDAA, 0xAD8B, 0x9DE8, 0x8DC9,
+    0x7C26, 0x6C07, 0x5C64, 0x4C45, 0x3CA2, 0x2C83, 0x1CE0, 0x0CC1,
+    0xEF1F, 0xFF3E, 0xCF5D, 0xDF7C, 0xAF9B, 0xBFBA, 0x8FD9, 0x9FF8,
+    0x6E17, 0x7E36, 0x4E55, 0x5E74, 0x2E93, 0x3EB2, 0x0ED1, 0x1EF0,
+};
+
+uint16_t proto_crc16(uint16_t crc, const uint8_t *buf, uint32_t len) {
+    while (len--) {
+        crc = (uint16_t)((crc << 8) ^ crc_table[(crc >> 8) ^ *buf++]);
+    }
+    return crc;
+}
+
+// Argument bytes of each opcode + 1, 0: unknown opcode
+#define ARGS(n)     ((n) + 1)
+
+static const uint8_t cmd_args[256] = {
+    [PROTO_C_NEW]      = ARGS(0),
+    [PROTO_C_MOVE]     = ARGS(2),
+    [PROTO_C_BOARD]    = ARGS(4),
+    [PROTO_C_GET]      = ARGS(0),
+    [PROTO_C_END]      = ARGS(1),
+    [PROTO_C_ANALYZE]  = ARGS(4),
+    [PROTO_C_ANALYZE3] = ARGS(2),
+    [PROTO_C_SESSION]  = ARGS(2),
+    [PROTO_C_STATS]    = ARGS(0),
+    [PROTO_C_PLAY]     = ARGS(3),
+    [PROTO_C_STATE]    = ARGS(5),
+    [PROTO_C_STATUS]   = ARGS(1),
+    [PROTO_C_VALUES]   = ARGS(9),
+    [PROTO_C_COUNTS]   = ARGS(8),
+};
+
+int proto_cmd_len(uint8_t op) {
+    return (int)cmd_args[op] - 1;
+}
+
+/****************************************************************************
+ *  parser: one function per state, each returns the next state. The
+ *  states after PS_SYNC store the byte in raw[] first (proto_feed).
+ ***************************************************************************/
+enum { PS_SYNC, PS_LEN, PS_TYPE, PS_SEQ, PS_DATA, PS_CRC_HI, PS_CRC_LO,
+       PS_REJECT };             // frame rejected: parse raw[] again
+
+static uint8_t st_sync(ProtoParser *p, uint8_t c) {
+    if (c != PROTO_SYNC) {
+        p->stats.skipped++;
+        return PS_SYNC;
+    }
+    p->n = 0;
+    return PS_LEN;
+}
+
+static uint8_t st_len(ProtoParser *p, uint8_t c) {
+    if (c > PROTO_MAX_PAYLOAD) {
+        p->stats.len_errors++;
+        return PS_REJECT;
+    }
+    p->len = c;
+    return PS_TYPE;
+}
+
+static uint8_t st_type(ProtoParser *p, uint8_t c) {
+    p->type = c;
+    return PS_SEQ;
+}
+
+static uint8_t st_seq(ProtoParser *p, uint8_t c) {
+    p->seq = c;
+    return p->len ? PS_DATA : PS_CRC_HI;
+}
+
+static uint8_t st_data(ProtoParser *p, uint8_t c) {
+    (void)c;                    // in raw[]
+    return p->n < 3 + p->len ? PS_DATA : PS_CRC_HI;
+}
+
+static uint8_t st_crc_hi(ProtoParser *p, uint8_t c) {
+    (void)p;
+    (void)c;
+    return PS_CRC_LO;
+}
+
+static uint8_t st_crc_lo(ProtoParser *p, uint8_t c) {
+    uint16_t crc = proto_crc16(0xFFFF, p->raw, 3 + (uint32_t)p->len);
+    ProtoFrame f;
+
+    if ((p->raw[p->n - 2] << 8 | c) != crc) {
+        p->stats.crc_errors++;
+        if (p->on_error) {
+            p->on_error(p->seq, PROTO_S_CRC);
+        }
+        return PS_REJECT;
+    }
+    p->stats.frames++;
+    f.type = p->type;
+    f.seq = p->seq;
+    f.len = p->len;
+    f.payload = p->raw + 3;
+    p->on_frame(&f);
+    return PS_SYNC;
+}
+
+static uint8_t (*const states[])(ProtoParser *, uint8_t) = {
+    [PS_SYNC]   = st_sync,
+    [PS_LEN]    = st_len,
+    [PS_TYPE]   = st_type,
+    [PS_SEQ]    = st_seq,
+    [PS_DATA]   = st_data,
+    [PS_CRC_HI] = st_crc_hi,
+    [PS_CRC_LO] = st_crc_lo,
+};
+
+void proto_init(ProtoParser *p, OnProtoFrame on_frame, OnProtoError on_error) {
+    memset(p, 0, sizeof(*p));
+    p->state = PS_SYNC;
+    p->on_frame = on_frame;
+    p->on_error = on_error;
+}
+
+static uint8_t step(ProtoParser *p, uint8_t state, uint8_t c) {
+    if (state != PS_SYNC) {
+        p->raw[p->n++] = c;
+    }
+    return states[state](p, c);
+}
+
+// The frame in raw[] was rejected: look for a SYNC in its bytes and parse
+// them again from there, again after each frame rejected among them. The
+// frame being parsed at the end may go on with the next bytes fed.
+static uint8_t resync(ProtoParser *p) {
+    uint8_t bytes[sizeof(p->raw)];
+    uint32_t len = p->n, i = 0, start = 0;     // start: after its SYNC
+    uint8_t state = PS_SYNC;
+
+    memcpy(bytes, p->raw, len);
+    while (i < len) {
+        if (state == PS_SYNC) {
+            start = i + 1;
+        }
+        state = step(p, state, bytes[i++]);
+        if (state == PS_REJECT) {
+            i = start;
+            state = PS_SYNC;
+        }
+    }
+    return state;
+}
+
+void proto_feed(ProtoParser *p, const uint8_t *buf, uint32_t len) {
+    uint8_t state = p->state;
+
+    while (len--) {
+        state = step(p, state, *buf++);
+        if (state == PS_REJECT) {
+            state = resync(p);
+        }
+    }
+    p->state = state;
+}
+
+/****************************************************************************
+ *  frames and commands
+ ***************************************************************************/
+uint32_t proto_frame(uint8_t *buf, uint8_t type, uint8_t seq,
+                     const uint8_t *payload, uint32_t len) {
+    uint16_t crc;
+
+    buf[0] = PROTO_SYNC;
+    buf[1] = (uint8_t)len;
+    buf[2] = type;
+    buf[3] = seq;
+    memcpy(buf + 4, payload, len);
+    crc = proto_crc16(0xFFFF, buf + 1, len + 3);
+    buf[len + 4] = (uint8_t)(crc >> 8);
+    buf[len + 5] = (uint8_t)crc;
+    return len + PROTO_OVERHEAD;
+}
+
+int proto_cmd_next(const ProtoFrame *f, uint32_t *pos, const uint8_t **args) {
+    uint32_t i = *pos;
+    int n;
+
+    if (i >= f->len) {
+        return 0;
+    }
+    n = proto_cmd_len(f->payload[i]);
+    if (n < 0 || i + 1 + (uint32_t)n > f->len) {
+        return -1;
+    }
+    *args = &f->payload[i + 1];
+    *pos = i + 1 + (uint32_t)n;
+    return f->payload[i];
+}
+
+int proto_put(uint8_t *buf, uint32_t *len, uint32_t max,
+              uint8_t op, const uint8_t *args) {
+    int n = proto_cmd_len(op);
+
+    if (n < 0 || *len + 1 + (uint32_t)n > max) {
+        return -1;
+    }
+    buf[*len] = op;
+    memcpy(buf + *len + 1, args, (uint32_t)n);
+    *len += 1 + (uint32_t)n;
+    return 0;
+}
@@ -0,0 +1,156 @@
+#ifndef _PROTO_H_
+#define _PROTO_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/* Framed binary protocol on the serial link.
+ *
+ *   SYNC  LEN  TYPE  SEQ  PAYLOAD[LEN]  CRC_HI  CRC_LO
+ *
+ * The CRC is the CRC-16/CCITT (polynomial 0x1021, initial value 0xFFFF)
+ * of LEN, TYPE, SEQ and PAYLOAD. The host sends PROTO_F_CMD frames; the
+ * board answers each of them with a PROTO_F_REPLY frame of the same SEQ
+ * (the acknowledgement), or a PROTO_F_NAK frame when the CRC is wrong.
+ * A frame sent again with the same SEQ is not executed twice: the last
+ * reply is sent again.
+ *
+ * The payload is a list of commands, an opcode followed by a fixed number
+ * of argument bytes (proto_cmd_len), so several commands can be sent in
+ * one frame. The reply holds the results in the same order.
+ *
+ * Game commands apply to the session (src/session.h) selected by the
+ * last PROTO_C_SESSION of the frame, session 0 if none.
+ *
+ * PROTO_C_ANALYZE and PROTO_C_ANALYZE3 do not touch the game: they give
+ * the value (int8_t, see ai_analyze) of every move on the board they
+ * carry, as two 9-bit masks or as a base-3 index (ai_board_from_index).
+ * PROTO_C_STATS returns how many of them were answered and the CPU
+ * cycles they took, both free running 32-bit counters: the rate is the
+ * difference between two reads.
+ */
+#define PROTO_SYNC              0xA5
+#define PROTO_MAX_PAYLOAD       128
+#define PROTO_OVERHEAD          6
+#define PROTO_FRAME_MAX         (PROTO_MAX_PAYLOAD + PROTO_OVERHEAD)
+
+/* Frame types */
+#define PROTO_F_CMD             0x01    /* host -> board */
+#define PROTO_F_REPLY           0x02    /* board -> host */
+#define PROTO_F_NAK             0x03    /* board -> host, payload: error */
+
+/* Commands: opcode (arguments) */
+#define PROTO_C_NEW             0x01    /* () new game */
+#define PROTO_C_MOVE            0x02    /* (row, col) player move */
+#define PROTO_C_BOARD           0x03    /* (x lo, x hi, o lo, o hi) set board */
+#define PROTO_C_GET             0x04    /* () get the board */
+#define PROTO_C_END             0x05    /* (PROTO_END_*) the game is over */
+#define PROTO_C_ANALYZE         0x06    /* (x lo, x hi, o lo, o hi) values */
+#define PROTO_C_ANALYZE3        0x07    /* (index lo, index hi) values */
+#define PROTO_C_SESSION         0x08    /* (id lo, id hi) select the game */
+#define PROTO_C_STATS           0x09    /* () analysis counters */
+
+/* Results */
+#define PROTO_C_PLAY            0x81    /* (row, col, value) AI move */
+#define PROTO_C_STATE           0x82    /* (x lo, x hi, o lo, o hi, flags) */
+#define PROTO_C_STATUS          0x83    /* (PROTO_S_*) command failed */
+#define PROTO_C_VALUES          0x84    /* (value of cells 0..8) analysis */
+#define PROTO_C_COUNTS          0x85    /* (queries, cycles: uint32 LE) */
+
+#define PROTO_STATE_OVER        0x01    /* PROTO_C_STATE flags */
+#define PROTO_STATE_WON         0x02
+
+#define PROTO_END_LOST          0       /* the AI lost */
+#define PROTO_END_WON           1       /* the AI won */
+
+#define PROTO_S_ILLEGAL         1       /* cell taken or out of the board,
+                                           impossible board */
+#define PROTO_S_OVER            2       /* the game is over */
+#define PROTO_S_BAD_CMD         3       /* unknown opcode, truncated args */
+#define PROTO_S_FULL            4       /* reply full, commands skipped */
+#define PROTO_S_CRC             5       /* NAK: wrong CRC */
+
+typedef struct {
+    uint8_t type;
+    uint8_t seq;
+    uint8_t len;
+    const uint8_t *payload;
+} ProtoFrame;
+
+typedef void (*OnProtoFrame)(const ProtoFrame *f);
+typedef void (*OnProtoError)(uint8_t seq, uint8_t error);
+
+typedef struct {
+    uint32_t frames;            /* good frames */
+    uint32_t crc_errors;
+    uint32_t len_errors;        /* LEN over PROTO_MAX_PAYLOAD */
+    uint32_t skipped;           /* bytes dropped looking for SYNC */
+} ProtoStats;
+
+/* The parser keeps every byte after the SYNC of the frame being parsed.
+ * When the frame is rejected (LEN too big, wrong CRC), its SYNC may have
+ * been noise and a real frame may start among those bytes: they are
+ * parsed again from the next SYNC.
+ */
+typedef struct {
+    uint8_t      state;
+    uint8_t      len;
+    uint8_t      type;
+    uint8_t      seq;
+    uint8_t      n;             /* bytes after SYNC received */
+    uint8_t      raw[PROTO_FRAME_MAX - 1];  /* LEN TYPE SEQ PAYLOAD CRC */
+    OnProtoFrame on_frame;
+    OnProtoError on_error;      /* may be NULL */
+    ProtoStats   stats;
+} ProtoParser;
+
+/* proto_crc16
+ *   CRC of len bytes of buf, continuing from crc (0xFFFF to start)
+ */
+uint16_t proto_crc16(uint16_t crc, const uint8_t *buf, uint32_t len);
+
+/* proto_init
+ *   reset parser p; on_frame is called for each good frame, on_error (if
+ *   not NULL) for each frame with a wrong CRC
+ */
+void proto_init(ProtoParser *p, OnProtoFrame on_frame, OnProtoError on_error);
+
+/* proto_feed
+ *   parse len bytes of the stream. The frame handed to on_frame is only
+ *   valid during the call. A frame that follows a false SYNC is handed
+ *   over once enough bytes have come to reject the false one.
+ */
+void proto_feed(ProtoParser *p, const uint8_t *buf, uint32_t len);
+
+/* proto_frame
+ *   encode a frame in buf (PROTO_FRAME_MAX bytes), return its size
+ */
+uint32_t proto_frame(uint8_t *buf, uint8_t type, uint8_t seq,
+                     const uint8_t *payload, uint32_t len);
+
+/* proto_cmd_len
+ *   number of argument bytes of opcode op, or -1 if op is unknown
+ */
+int proto_cmd_len(uint8_t op);
+
+/* proto_cmd_next
+ *   next command of frame f from offset *pos: set *args and advance *pos,
+ *   return the opcode, 0 at the end of the payload, or -1 if the opcode
+ *   is unknown or its arguments are truncated
+ */
+int proto_cmd_next(const ProtoFrame *f, uint32_t *pos, const uint8_t **args);
+
+/* proto_put
+ *   append command op and its arguments to buf (max bytes) at *len,
+ *   return 0, or -1 if it does not fit
+ */
+int proto_put(uint8_t *buf, uint32_t *len, uint32_t max,
+              uint8_t op, const uint8_t *args);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
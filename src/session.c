@@ -0,0 +1,60 @@
+#include <string.h>
+#include "src/session.h"
+
+SessionStats session_stats;
+
+static Session sessions[SESSION_MAX];
+static uint32_t now = 0;        // session_get() calls
+
+void session_init(void) {
+    memset(sessions, 0, sizeof(sessions));
+    memset(&session_stats, 0, sizeof(session_stats));
+    now = 0;
+}
+
+Session *session_get(uint8_t port, uint16_t id) {
+    Session *lru = &sessions[0];
+
+    now++;
+    for (int i = 0; i < SESSION_MAX; ++i) {
+        Session *s = &sessions[i];
+
+        if ((s->cells & SESSION_USED) && s->id == id && s->port == port) {
+            session_stats.hits++;
+            s->stamp = now;
+            return s;
+        }
+        // free slots come first, then the oldest session
+        if (!(s->cells & SESSION_USED)) {
+            if (lru->cells & SESSION_USED) {
+                lru = s;
+            }
+        } else if ((lru->cells & SESSION_USED) &&
+                   now - s->stamp > now - lru->stamp) {
+            lru = s;
+        }
+    }
+
+    if (lru->cells & SESSION_USED) {
+        session_stats.evicted++;
+    }
+    session_stats.created++;
+    lru->cells = SESSION_USED;
+    lru->id = id;
+    lru->port = port;
+    lru->stamp = now;
+    return lru;
+}
+
+Board session_board(const Session *s) {
+    Board b;
+
+    b.x = (uint16_t)(s->cells & SESSION_X);
+    b.o = (uint16_t)((s->cells & SESSION_O) >> 9);
+    return b;
+}
+
+void session_set_board(Session *s, Board b) {
+    s->cells = (s->cells & ~(SESSION_X | SESSION_O)) |
+               b.x | ((uint32_t)b.o << 9);
+}
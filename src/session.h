@@ -0,0 +1,66 @@
+#ifndef _SESSION_H_
+#define _SESSION_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "src/ai.h"
+
+/* Game sessions, selected by the host with a 16-bit id (PROTO_C_SESSION)
+ * on one of the serial ports, each port having its own ids. Each one
+ * costs 12 bytes: the board packed in one word with the game flags, the
+ * port and id, and the time of last use. When the table is full, a new
+ * id takes the place of the least recently used session.
+ */
+#ifndef SESSION_MAX
+#define SESSION_MAX     64
+#endif
+
+#define SESSION_X       0x000001FFu     /* AI_HUMAN cells */
+#define SESSION_O       0x0003FE00u     /* AI_CPU cells, shifted by 9 */
+#define SESSION_OVER    (1u << 18)      /* the game is over */
+#define SESSION_WON     (1u << 19)      /* ... and the AI won */
+#define SESSION_USED    (1u << 20)
+
+typedef struct {
+    uint32_t cells;             /* board and SESSION_* flags */
+    uint32_t stamp;             /* last use, for the LRU eviction */
+    uint16_t id;
+    uint8_t  port;
+} Session;
+
+typedef struct {
+    uint32_t hits;              /* lookups of a live session */
+    uint32_t created;           /* new sessions, evictions included */
+    uint32_t evicted;           /* sessions dropped to make room */
+} SessionStats;
+
+extern SessionStats session_stats;
+
+/* session_init
+ *   drop every session
+ */
+void session_init(void);
+
+/* session_get
+ *   session 'id' of 'port', marked as the most recently used. An unknown id starts
+ *   a new game, in place of the least recently used session if needed.
+ */
+Session *session_get(uint8_t port, uint16_t id);
+
+/* session_board
+ *   board of session s
+ */
+Board session_board(const Session *s);
+
+/* session_set_board
+ *   store board b in session s, keep the flags
+ */
+void session_set_board(Session *s, Board b);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
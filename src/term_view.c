@@ -0,0 +1,43 @@
+#include "lib/term.h"
+#include "src/term_view.h"
+
+// Top left cell of the grid, 4 columns and 2 rows apart
+#define VIEW_X      4
+#define VIEW_Y      3
+#define STATUS_Y    (VIEW_Y + 6)
+
+void term_view_init(void) {
+    term_screen_init();
+    term_screen_color(CL_DEFAULT, CL_BRIGHT);
+    term_screen_puts(VIEW_X - 1, 1, "Tic-tac-toe");
+    term_screen_color(CL_DEFAULT, CL_NORMAL);
+    for (int r = 0; r < 3; ++r) {
+        term_screen_puts(VIEW_X - 1, VIEW_Y + 2 * r, "   |   |   ");
+        if (r < 2) {
+            term_screen_puts(VIEW_X - 1, VIEW_Y + 2 * r + 1, "---+---+---");
+        }
+    }
+    term_flush();
+}
+
+unsigned int term_view_draw(Board b, const char *status) {
+    for (int r = 0; r < 3; ++r) {
+        for (int c = 0; c < 3; ++c) {
+            unsigned int x = VIEW_X + 4 * (unsigned int)c, y = VIEW_Y + 2 * (unsigned int)r;
+
+            if (b.x & AI_CELL(r, c)) {
+                term_screen_color(CL_RED, CL_BRIGHT);
+                term_screen_puts(x, y, "X");
+            } else if (b.o & AI_CELL(r, c)) {
+                term_screen_color(CL_BLUE, CL_BRIGHT);
+                term_screen_puts(x, y, "O");
+            } else {
+                term_screen_color(CL_DEFAULT, CL_NORMAL);
+                term_screen_puts(x, y, " ");
+            }
+        }
+    }
+    term_screen_color(CL_DEFAULT, CL_NORMAL);
+    term_screen_printf(VIEW_X - 1, STATUS_Y, "%-*s", TERM_VIEW_STATUS_W, status);
+    return term_flush();
+}
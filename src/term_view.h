@@ -0,0 +1,32 @@
+#ifndef _TERM_VIEW_H_
+#define _TERM_VIEW_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "src/ai.h"
+
+/* The game board on a serial terminal (the screen model of lib/term.h):
+ * an ASCII grid with X in red and O in blue, and a status line below.
+ * The whole view is drawn into the model each time, term_flush() sends
+ * only the cells that changed: a move is a cursor move, a color and a
+ * character.
+ */
+#define TERM_VIEW_STATUS_W  30      /* chars of the status line */
+
+/* term_view_init
+ *   clear the terminal, draw the title and the empty grid
+ */
+void term_view_init(void);
+
+/* term_view_draw
+ *   draw the cells of board b and the status text, padded to
+ *   TERM_VIEW_STATUS_W; return the bytes sent to the terminal
+ */
+unsigned int term_view_draw(Board b, const char *status);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,42 @@
+/*
+ * check_table : compare the compile-time solved move table
+ *               (src/ai_table.hpp) with the game engine (src/ai.c) on
+ *               every position, exit with an error if they disagree.
+ */
+#include <stdio.h>
+#include "src/ai.h"
+#include "src/ai_table.hpp"
+
+int main(void)
+{
+    int checked = 0, errors = 0;
+
+    ai_init();
+
+    for (int i = 0; i < AI_TABLE_SIZE; ++i) {
+        uint8_t e = ai_cx::table.moves[i];
+        Board b = {0, 0};
+        int row, col, value;
+
+        if (e == AI_TABLE_NONE) {
+            continue;
+        }
+        for (int k = 0, v = i; k < 9; ++k, v /= 3) {
+            if (v % 3 == 1) {
+                b.x = (uint16_t)(b.x | (1u << k));
+            } else if (v % 3 == 2) {
+                b.o = (uint16_t)(b.o | (1u << k));
+            }
+        }
+        value = ai_best_move(b, &row, &col);
+        if (e != AI_TABLE_ENTRY(row * 3 + col, value)) {
+            fprintf(stderr, "check_table: position %d: table 0x%02X, "
+                    "search cell %d value %d\n", i, e, row * 3 + col, value);
+            errors++;
+        }
+        checked++;
+    }
+
+    printf("check_table: %d positions, %d errors\n", checked, errors);
+    return errors != 0;
+}
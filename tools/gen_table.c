@@ -0,0 +1,69 @@
+/*
+ * gen_table : solve every tic-tac-toe position with the game engine
+ *             (src/ai.c, built for the host) and print the perfect-play
+ *             move table as C source on stdout (see src/ai_table.h).
+ *
+ * usage: gen_table > src/ai_table_data.c
+ */
+#include <stdio.h>
+#include "src/ai.h"
+#include "src/ai_table.h"
+
+int main(void)
+{
+    static uint8_t table[AI_TABLE_SIZE];
+    uint16_t base3[512];
+    int solved = 0;
+
+    ai_init();
+
+    // base3[m]: base-3 index of the cells in mask m, each counted as 1
+    for (int m = 0; m < 512; ++m) {
+        int v = 0;
+        for (int k = 8; k >= 0; --k) {
+            v = v * 3 + ((m >> k) & 1);
+        }
+        base3[m] = (uint16_t)v;
+    }
+
+    for (int i = 0; i < AI_TABLE_SIZE; ++i) {
+        Board b = {0, 0};
+        int nx = 0, no = 0, row, col, value;
+
+        for (int k = 0, v = i; k < 9; ++k, v /= 3) {
+            if (v % 3 == 1) {
+                b.x |= (uint16_t)(1u << k);
+                nx++;
+            } else if (v % 3 == 2) {
+                b.o |= (uint16_t)(1u << k);
+                no++;
+            }
+        }
+
+        // only unfinished positions with the AI (O) to play
+        table[i] = AI_TABLE_NONE;
+        if (nx != no + 1 || ai_check_win(b.x) || ai_check_win(b.o) ||
+            ai_check_draw(b)) {
+            continue;
+        }
+        value = ai_best_move(b, &row, &col);
+        table[i] = AI_TABLE_ENTRY(row * 3 + col, value);
+        solved++;
+    }
+
+    printf("/* Generated by tools/gen_table.c, do not edit */\n");
+    printf("/* %d positions solved */\n\n", solved);
+    printf("#include \"src/ai_table.h\"\n\n");
+
+    printf("const AiTable ai_table = {\n  {");
+    for (int m = 0; m < 512; ++m) {
+        printf("%s%5u,", (m % 12) ? " " : "\n    ", base3[m]);
+    }
+    printf("\n  },\n  {");
+    for (int i = 0; i < AI_TABLE_SIZE; ++i) {
+        printf("%s0x%02X,", (i % 16) ? " " : "\n    ", table[i]);
+    }
+    printf("\n  }\n};\n");
+
+    return 0;
+}
@@ -0,0 +1,32 @@
+/*
+ * board.h : host stand-in for include/board.h, the registers the display
+ *           code touches (src/display.c) as plain memory, with the pin
+ *           configuration of include/config.h. See tools/lcd_host.h.
+ */
+#ifndef _BOARD_H_
+#define _BOARD_H_
+
+#include <stdint.h>
+
+typedef struct { volatile uint32_t MODER, ODR; } GPIO_t;
+typedef struct { volatile uint32_t CR1, CR2, SR, DR; } SPI_t;
+typedef struct { volatile uint32_t CR, NDTR, PAR; volatile uintptr_t M0AR; } DMA_Stream_t;
+typedef struct { volatile uint32_t LISR, HISR, LIFCR, HIFCR; } DMA_t;
+
+extern GPIO_t host_gpioa, host_gpiob, host_gpioc;
+extern SPI_t host_spi1;
+extern DMA_t host_dma2;
+
+#define _GPIOA              (&host_gpioa)
+#define _GPIOB              (&host_gpiob)
+#define _GPIOC              (&host_gpioc)
+#define _SPI1               (&host_spi1)
+#define _DMA2               (&host_dma2)
+
+#define SPI_CR2_RXDMAEN     (1U << 0)
+#define SPI_CR2_TXDMAEN     (1U << 1)
+#define SPI_SR_TXE          (1U << 1)
+
+#include "include/config.h"
+
+#endif
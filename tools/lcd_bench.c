@@ -0,0 +1,189 @@
+/*
+ * lcd_bench : the display code built for the host against the LCD model
+ *             (tools/lcd_host.h): SPI bytes and CPU time of each way of
+ *             showing a game, and comparison of reference screens with
+ *             the golden images of tools/golden.
+ *
+ * usage: lcd_bench [-g]
+ *        -g : save the reference screens as the new golden images
+ */
+#define _POSIX_C_SOURCE 199309L
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "libshield/lcd_128x32.h"
+#include "src/ai.h"
+#include "src/display.h"
+#include "src/board_view.h"
+#include "tools/lcd_host.h"
+
+#define UPDATES     1000
+#define GOLDEN_DIR  "tools/golden/"
+
+#define TEXT_X      (BOARD_VIEW_SIZE + 4)   // as src/main.c
+#define TEXT_Y      12
+
+// Game events: a move on the board, AI or player in turn
+static Board boards[UPDATES];
+static int rows[UPDATES], cols[UPDATES];
+
+static void make_games(void) {
+    Board b = { 0, 0 };
+    unsigned int seed = 12345;
+
+    for (int i = 0; i < UPDATES; ++i) {
+        int k;
+
+        if ((b.x | b.o) == AI_CELLS) {
+            b.x = b.o = 0;
+        }
+        seed = seed * 1103515245 + 12345;
+        for (k = (int)(seed >> 16) % 9; (b.x | b.o) & (1u << k); k = (k + 1) % 9) {}
+        if (i & 1) {
+            b.o = (uint16_t)(b.o | 1u << k);
+        } else {
+            b.x = (uint16_t)(b.x | 1u << k);
+        }
+        boards[i] = b;
+        rows[i] = k / 3;
+        cols[i] = k % 3;
+    }
+}
+
+/****************************************************************************
+ *  ways of showing the game
+ ***************************************************************************/
+// the former main loop: clear and print with the libshield API
+static void show_libshield(int i) {
+    cls();
+    locate(0, 0);
+    lcd_printf("row = %d, col = %d", rows[i], cols[i]);
+}
+
+// the same, sent once the screen is drawn
+static void show_libshield_once(int i) {
+    lcd_set_autoup(0);
+    cls();
+    locate(0, 0);
+    lcd_printf("row = %d, col = %d", rows[i], cols[i]);
+    lcd_set_autoup(1);
+}
+
+// text in a framebuffer, changed columns sent (src/display.h)
+static void show_display(int i) {
+    display_clear();
+    display_printf(0, 0, "row = %d, col = %d", rows[i], cols[i]);
+    display_flush();
+}
+
+// board tiles and text, as src/main.c
+static void show_board(int i) {
+    board_view_update(boards[i]);
+    display_fillrect(TEXT_X, 0, DISPLAY_WIDTH - 1, DISPLAY_HEIGHT - 1, 0);
+    display_printf(TEXT_X, TEXT_Y, "AI: row %d col %d", rows[i], cols[i]);
+    display_flush();
+}
+
+typedef struct {
+    const char *name;
+    void (*show)(int i);
+} Way;
+
+static const Way ways[] = {
+    { "libshield, auto update", show_libshield },
+    { "libshield, one update", show_libshield_once },
+    { "display, page diff", show_display },
+    { "board tiles", show_board },
+};
+
+static void bench(const Way *w) {
+    struct timespec t0, t1;
+
+    lcd_host_reset();
+    lcd_reset();
+    display_init();
+    board_view_draw(boards[0]);
+    display_flush();
+    lcd_host_reset();
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (int i = 0; i < UPDATES; ++i) {
+        w->show(i);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    double ns = (double)(t1.tv_sec - t0.tv_sec) * 1e9 + (double)(t1.tv_nsec - t0.tv_nsec);
+    printf("%-24s: %6u bytes/update, %5.0f ns/update\n", w->name,
+           lcd_host_stats.bytes / UPDATES, ns / UPDATES);
+}
+
+/****************************************************************************
+ *  golden images
+ ***************************************************************************/
+static void screen_board(void) {
+    Board b = { AI_CELL(0, 0) | AI_CELL(1, 1) | AI_CELL(2, 0),
+                AI_CELL(0, 2) | AI_CELL(2, 2) };
+
+    display_init();
+    display_clear();
+    board_view_draw(b);
+    display_text(TEXT_X, TEXT_Y, "AI: row 2 col 2");
+    display_flush();
+}
+
+static void screen_shapes(void) {
+    static uint8_t arrow[] = { 0x18, 0x3C, 0x7E, 0xFF, 0x18, 0x18, 0x18, 0x18 };
+    Bitmap bm = { 8, 8, 1, arrow };
+
+    lcd_reset();
+    rect(0, 0, 127, 31, 1);
+    line(2, 2, 40, 29, 1);
+    circle(58, 15, 10, 1);
+    fillcircle(84, 15, 8, 1);
+    fillrect(98, 4, 110, 27, 1);
+    bitmap(&bm, 115, 12);
+    locate(4, 4);
+    lcd_printf("%d", 42);
+}
+
+typedef struct {
+    const char *name;
+    void (*draw)(void);
+} Screen;
+
+static const Screen screens[] = {
+    { "board", screen_board },
+    { "shapes", screen_shapes },
+};
+
+int main(int argc, char **argv) {
+    int save = argc > 1 && strcmp(argv[1], "-g") == 0;
+    int failed = 0;
+
+    make_games();
+    for (unsigned i = 0; i < sizeof(ways) / sizeof(ways[0]); ++i) {
+        bench(&ways[i]);
+    }
+
+    for (unsigned i = 0; i < sizeof(screens) / sizeof(screens[0]); ++i) {
+        char path[64];
+        int diff;
+
+        snprintf(path, sizeof(path), GOLDEN_DIR "%s.pbm", screens[i].name);
+        lcd_host_reset();
+        screens[i].draw();
+        if (save) {
+            diff = lcd_host_save_pbm(path);
+            printf("%-24s: %s\n", path, diff ? "not saved" : "saved");
+        } else {
+            diff = lcd_host_compare_pbm(path);
+            if (diff < 0) {
+                printf("%-24s: cannot be read\n", path);
+            } else {
+                printf("%-24s: %d pixels differ\n", path, diff);
+            }
+        }
+        failed |= diff != 0;
+    }
+    return failed;
+}
@@ -0,0 +1,440 @@
+/*
+ * lcd_host : model of the shield LCD on the host, see tools/lcd_host.h
+ */
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include "include/board.h"
+#include "lib/io.h"
+#include "lib/spi.h"
+#include "lib/dma.h"
+#include "lib/fmt.h"
+#include "libshield/lcd_128x32.h"
+#include "src/font.h"
+#include "tools/lcd_host.h"
+
+#define WIDTH       128
+#define HEIGHT      32
+#define PAGES       (HEIGHT / 8)
+#define RAM_COLS    132             // ST7565 display RAM, 128 shown
+
+GPIO_t host_gpioa, host_gpiob, host_gpioc;
+SPI_t host_spi1 = { .SR = SPI_SR_TXE };     // never busy
+DMA_t host_dma2;
+
+LcdHostStats lcd_host_stats;
+
+/****************************************************************************
+ *  ST7565
+ ***************************************************************************/
+static uint8_t ram[PAGES][RAM_COLS];
+static int page, col;
+static int a0 = 1, cs = 1;          // A0 high: data, CS low: selected
+static int arg;                     // command waiting for its argument
+
+static void st7565_write(uint8_t b) {
+    if (cs) {
+        return;
+    }
+    lcd_host_stats.bytes++;
+    if (a0) {
+        if (page < PAGES && col < RAM_COLS) {
+            ram[page][col] = b;
+        }
+        if (col < RAM_COLS) {
+            col++;
+        }
+        return;
+    }
+
+    lcd_host_stats.commands++;
+    if (arg) {                      // contrast, booster ratio
+        arg = 0;
+    } else if ((b & 0xF0) == 0xB0) {
+        page = b & 0x0F;
+    } else if ((b & 0xF0) == 0x10) {
+        col = (col & 0x0F) | (b & 0x0F) << 4;
+    } else if ((b & 0xF0) == 0x00) {
+        col = (col & 0xF0) | (b & 0x0F);
+    } else if (b == 0x81 || b == 0xF8) {
+        arg = 1;
+    }
+}
+
+void lcd_host_reset(void) {
+    memset(ram, 0, sizeof(ram));
+    memset(&lcd_host_stats, 0, sizeof(lcd_host_stats));
+    page = col = arg = 0;
+}
+
+int lcd_host_pixel(int x, int y) {
+    return ram[y / 8][x] >> (y % 8) & 1;
+}
+
+int lcd_host_save_pbm(const char *path) {
+    FILE *f = fopen(path, "w");
+
+    if (!f) {
+        return -1;
+    }
+    fprintf(f, "P1\n%d %d\n", WIDTH, HEIGHT);
+    for (int y = 0; y < HEIGHT; ++y) {
+        for (int x = 0; x < WIDTH; ++x) {
+            fputc('0' + lcd_host_pixel(x, y), f);
+        }
+        fputc('\n', f);
+    }
+    return fclose(f) ? -1 : 0;
+}
+
+// Next number of a PBM header, comments skipped
+static int pbm_number(FILE *f) {
+    int c, n = 0, digits = 0;
+
+    while ((c = fgetc(f)) != EOF) {
+        if (c == '#') {
+            while ((c = fgetc(f)) != EOF && c != '\n') {}
+        } else if (c >= '0' && c <= '9') {
+            n = n * 10 + c - '0';
+            digits++;
+        } else if (digits) {
+            break;
+        }
+    }
+    return digits ? n : -1;
+}
+
+int lcd_host_compare_pbm(const char *path) {
+    FILE *f = fopen(path, "r");
+    int diff = 0;
+
+    if (!f) {
+        return -1;
+    }
+    if (fgetc(f) != 'P' || fgetc(f) != '1' ||
+        pbm_number(f) != WIDTH || pbm_number(f) != HEIGHT) {
+        fclose(f);
+        return -1;
+    }
+    for (int i = 0; i < WIDTH * HEIGHT; ) {
+        int c = fgetc(f);
+
+        if (c == EOF) {
+            fclose(f);
+            return -1;
+        }
+        if (c == '0' || c == '1') {
+            diff += (c - '0') != lcd_host_pixel(i % WIDTH, i / WIDTH);
+            i++;
+        }
+    }
+    fclose(f);
+    return diff;
+}
+
+/****************************************************************************
+ *  lib/io.h, lib/spi.h, lib/dma.h: the calls of the display code
+ ***************************************************************************/
+void io_set(GPIO_t *gpio, uint16_t mask) {
+    if (gpio == LCD_A0_GPIO_PORT && (mask & LCD_A0_GPIO_PINS)) a0 = 1;
+    if (gpio == LCD_CS_N_GPIO_PORT && (mask & LCD_CS_N_GPIO_PINS)) cs = 1;
+}
+
+void io_clear(GPIO_t *gpio, uint16_t mask) {
+    if (gpio == LCD_A0_GPIO_PORT && (mask & LCD_A0_GPIO_PINS)) a0 = 0;
+    if (gpio == LCD_CS_N_GPIO_PORT && (mask & LCD_CS_N_GPIO_PINS)) cs = 0;
+}
+
+void spi_write(SPI_t *spi, uint8_t *data, uint32_t n) {
+    while (n--) {
+        st7565_write(*data++);
+    }
+}
+
+void spi_write_byte(SPI_t *spi, uint8_t data) {
+    st7565_write(data);
+}
+
+// SPI1 transmit and receive streams: a transfer is done as soon as it
+// starts, the receive stream ends with the transmit one
+static DMA_Stream_t tx_stream, rx_stream;
+static OnTC tx_tc, rx_tc;
+static int rx_pending;
+
+DMA_Stream_t *dma_stream_init(DMA_t *dma, uint32_t s, DMAEndPoint_t *src, DMAEndPoint_t *dest, uint32_t mode, OnTC cb) {
+    if (src->type == EP_SPI_RX) {
+        rx_tc = cb;
+        return &rx_stream;
+    }
+    tx_tc = cb;
+    return &tx_stream;
+}
+
+int dma_start(DMA_Stream_t *s, uint16_t size) {
+    if (s == &rx_stream) {
+        rx_pending = 1;
+        return 0;
+    }
+    spi_write(_SPI1, (uint8_t *)s->M0AR, size);
+    if (tx_tc) {
+        tx_tc(0, 0);
+    }
+    if (rx_pending) {
+        rx_pending = 0;
+        if (rx_tc) {
+            rx_tc(0, 0);
+        }
+    }
+    return 0;
+}
+
+/****************************************************************************
+ *  libshield/lcd_128x32.h
+ ***************************************************************************/
+static uint8_t buffer[PAGES][WIDTH];
+static unsigned int auto_up = 1;
+static unsigned int contrast = 0x17;
+static int draw_mode = NORMAL;
+static int char_x, char_y;
+
+// the whole buffer, a page at a time
+static void lcd_update(void) {
+    for (int p = 0; p < PAGES; ++p) {
+        uint8_t cmd[3] = { 0x00, 0x10, (uint8_t)(0xB0 | p) };
+
+        io_clear(LCD_CS_N_GPIO_PORT, LCD_CS_N_GPIO_PINS);
+        io_clear(LCD_A0_GPIO_PORT, LCD_A0_GPIO_PINS);
+        spi_write(_SPI1, cmd, sizeof(cmd));
+        io_set(LCD_A0_GPIO_PORT, LCD_A0_GPIO_PINS);
+        spi_write(_SPI1, buffer[p], WIDTH);
+        io_set(LCD_CS_N_GPIO_PORT, LCD_CS_N_GPIO_PINS);
+    }
+    lcd_host_stats.updates++;
+}
+
+static void lcd_command(uint8_t c) {
+    io_clear(LCD_CS_N_GPIO_PORT, LCD_CS_N_GPIO_PINS);
+    io_clear(LCD_A0_GPIO_PORT, LCD_A0_GPIO_PINS);
+    spi_write(_SPI1, &c, 1);
+    io_set(LCD_CS_N_GPIO_PORT, LCD_CS_N_GPIO_PINS);
+}
+
+static void auto_update(void) {
+    if (auto_up) {
+        lcd_update();
+    }
+}
+
+static void pixel(int x, int y, int color) {
+    uint8_t bit;
+
+    if (x < 0 || x >= WIDTH || y < 0 || y >= HEIGHT) {
+        return;
+    }
+    bit = (uint8_t)(1u << (y & 7));
+    if (draw_mode == XOR) {
+        if (color) {
+            buffer[y >> 3][x] ^= bit;
+        }
+    } else if (color) {
+        buffer[y >> 3][x] |= bit;
+    } else {
+        buffer[y >> 3][x] &= (uint8_t)~bit;
+    }
+}
+
+int lcd_reset() {
+    static const uint8_t init[] = {
+        0xAE, 0xA2, 0xA0, 0xC8, 0x22, 0x2F, 0x40, 0xAF, 0x81, 0x17, 0xA6
+    };
+
+    for (uint32_t i = 0; i < sizeof(init); ++i) {
+        lcd_command(init[i]);
+    }
+    draw_mode = NORMAL;
+    char_x = char_y = 0;
+    cls();
+    return 0;
+}
+
+void lcd_set_contrast(unsigned int o) {
+    contrast = o & 0x3F;
+    lcd_command(0x81);
+    lcd_command((uint8_t)contrast);
+}
+
+unsigned int lcd_get_contrast(void) {
+    return contrast;
+}
+
+int lcd_width() {
+    return WIDTH;
+}
+
+int lcd_height() {
+    return HEIGHT;
+}
+
+unsigned int lcd_get_autoup() {
+    return auto_up;
+}
+
+void lcd_set_autoup(unsigned int update) {
+    auto_up = update;
+    auto_update();
+}
+
+void lcd_setmode(int mode) {
+    draw_mode = mode;
+}
+
+void lcd_invert(unsigned int o) {
+    lcd_command(o ? 0xA7 : 0xA6);
+}
+
+void locate(int x, int y) {
+    char_x = x;
+    char_y = y;
+}
+
+void cls(void) {
+    memset(buffer, 0, sizeof(buffer));
+    auto_update();
+}
+
+void line(int x0, int y0, int x1, int y1, int color) {
+    int dx = x1 > x0 ? x1 - x0 : x0 - x1, sx = x0 < x1 ? 1 : -1;
+    int dy = y1 > y0 ? y0 - y1 : y1 - y0, sy = y0 < y1 ? 1 : -1;
+    int err = dx + dy;
+
+    for (;;) {
+        int e2 = 2 * err;
+
+        pixel(x0, y0, color);
+        if (x0 == x1 && y0 == y1) {
+            break;
+        }
+        if (e2 >= dy) {
+            err += dy;
+            x0 += sx;
+        }
+        if (e2 <= dx) {
+            err += dx;
+            y0 += sy;
+        }
+    }
+    auto_update();
+}
+
+void rect(int x0, int y0, int x1, int y1, int color) {
+    unsigned int up = auto_up;
+
+    auto_up = 0;
+    line(x0, y0, x1, y0, color);
+    line(x0, y1, x1, y1, color);
+    line(x0, y0, x0, y1, color);
+    line(x1, y0, x1, y1, color);
+    auto_up = up;
+    auto_update();
+}
+
+void fillrect(int x0, int y0, int x1, int y1, int color) {
+    for (int y = y0 < y1 ? y0 : y1; y <= (y0 < y1 ? y1 : y0); ++y) {
+        for (int x = x0 < x1 ? x0 : x1; x <= (x0 < x1 ? x1 : x0); ++x) {
+            pixel(x, y, color);
+        }
+    }
+    auto_update();
+}
+
+// midpoint circle, the 8 octants, or the 4 spans between them if fill
+static void circle_points(int x0, int y0, int r, int color, int fill) {
+    int x = r, y = 0, err = 1 - r;
+
+    while (x >= y) {
+        if (fill) {
+            for (int i = x0 - x; i <= x0 + x; ++i) {
+                pixel(i, y0 + y, color);
+                pixel(i, y0 - y, color);
+            }
+            for (int i = x0 - y; i <= x0 + y; ++i) {
+                pixel(i, y0 + x, color);
+                pixel(i, y0 - x, color);
+            }
+        } else {
+            pixel(x0 + x, y0 + y, color); pixel(x0 - x, y0 + y, color);
+            pixel(x0 + x, y0 - y, color); pixel(x0 - x, y0 - y, color);
+            pixel(x0 + y, y0 + x, color); pixel(x0 - y, y0 + x, color);
+            pixel(x0 + y, y0 - x, color); pixel(x0 - y, y0 - x, color);
+        }
+        y++;
+        if (err < 0) {
+            err += 2 * y + 1;
+        } else {
+            x--;
+            err += 2 * (y - x) + 1;
+        }
+    }
+}
+
+void circle(int x0, int y0, int r, int color) {
+    circle_points(x0, y0, r, color, 0);
+    auto_update();
+}
+
+void fillcircle(int x, int y, int r, int color) {
+    circle_points(x, y, r, color, 1);
+    auto_update();
+}
+
+void bitmap(Bitmap *bm, int x, int y) {
+    for (uint32_t j = 0; j < bm->height; ++j) {
+        for (uint32_t i = 0; i < bm->width; ++i) {
+            pixel(x + (int)i, y + (int)j,
+                  bm->data[j * bm->bytes_per_line + (i >> 3)] & (0x80u >> (i & 7)));
+        }
+    }
+    auto_update();
+}
+
+void lcd_putc(int value) {
+    char c = (char)value;
+
+    if (c == '\n' || char_x + 6 > WIDTH) {
+        char_x = 0;
+        char_y += 8;
+        if (char_y + 8 > HEIGHT) {
+            char_y = 0;
+        }
+    }
+    if (c != '\n') {
+        if (c < FONT_FIRST || c > FONT_LAST) {
+            c = '?';
+        }
+        for (int i = 0; i < 6; ++i) {
+            uint8_t bits = i < FONT_W ? font5x7[c - FONT_FIRST][i] : 0;
+
+            for (int k = 0; k < 8; ++k) {
+                pixel(char_x + i, char_y + k, bits >> k & 1);
+            }
+        }
+        char_x += 6;
+    }
+    auto_update();
+}
+
+void lcd_puts(char *s) {
+    while (*s) {
+        lcd_putc(*s++);
+    }
+}
+
+void lcd_printf(const char *fmt, ...) {
+    char s[64];
+    va_list ap;
+
+    va_start(ap, fmt);
+    fmt_vsnprintf(s, sizeof(s), fmt, ap);
+    va_end(ap);
+    lcd_puts(s);
+}
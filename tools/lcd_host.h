@@ -0,0 +1,49 @@
+/*
+ * lcd_host : model of the LCD of the mbed application shield, to build and
+ *            measure the display code on the host (make host).
+ *
+ * - The ST7565 controller: the bytes written on SPI1, by spi_write() or by
+ *   the DMA (lib/spi.h, lib/dma.h), go to its display RAM as commands or
+ *   data according to the A0 and CS lines (io_set/io_clear, lib/io.h).
+ *   They are counted.
+ * - The libshield API (libshield/lcd_128x32.h), drawing in its own
+ *   framebuffer and sending it whole at each update, as libshield.a does:
+ *   after each call when the auto update is on.
+ *
+ * The images are saved as plain PBM (P1), one text line per row.
+ */
+#ifndef _LCD_HOST_H_
+#define _LCD_HOST_H_
+
+#include <stdint.h>
+
+typedef struct {
+    uint32_t bytes;             /* bytes written on SPI */
+    uint32_t commands;          /* ... with A0 low */
+    uint32_t updates;           /* whole screens sent by the libshield API */
+} LcdHostStats;
+
+extern LcdHostStats lcd_host_stats;
+
+/* lcd_host_reset
+ *   blank display RAM, clear the counters
+ */
+void lcd_host_reset(void);
+
+/* lcd_host_pixel
+ *   pixel (x, y) of the panel, 1 if set
+ */
+int lcd_host_pixel(int x, int y);
+
+/* lcd_host_save_pbm
+ *   save the panel to the PBM file path, return 0 or -1
+ */
+int lcd_host_save_pbm(const char *path);
+
+/* lcd_host_compare_pbm
+ *   number of pixels of the panel that differ from the PBM file path,
+ *   -1 if it cannot be read or is not a 128x32 image
+ */
+int lcd_host_compare_pbm(const char *path);
+
+#endif
@@ -0,0 +1,254 @@
+/*
+ * proto_test : host fuzz test of the frame parser (src/proto.c). Valid
+ *              frames are mixed with random noise, false SYNC bytes and
+ *              corrupted frames, and fed to the parser in random chunks,
+ *              each from a buffer of its own size so that the address
+ *              sanitizer (make host) catches any read out of bounds.
+ *              Every valid frame must come out once, in order and
+ *              unchanged, unless noise that passed the CRC-16 (one false
+ *              frame in 65536) covered it.
+ *
+ * usage: proto_test (exit status 1 if a check fails)
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "src/proto.h"
+
+#define FRAMES      20000
+#define NOISE_MAX   40          // random bytes before each frame
+#define TAG         0x5A        // first payload byte of the valid frames
+
+static int checks, failures;
+
+#define CHECK(cond)     check((cond), #cond, __LINE__)
+
+static void check(int ok, const char *what, int line) {
+    checks++;
+    if (!ok) {
+        failures++;
+        printf("proto_test.c:%d: failed: %s\n", line, what);
+    }
+}
+
+static uint32_t rand_state = 1;
+
+static uint32_t test_rand(void) {
+    rand_state ^= rand_state << 13;     // xorshift32
+    rand_state ^= rand_state >> 17;
+    rand_state ^= rand_state << 5;
+    return rand_state;
+}
+
+/****************************************************************************
+ *  stream
+ ***************************************************************************/
+static uint8_t *stream;
+static uint32_t stream_len, stream_size;
+
+static void put(const uint8_t *buf, uint32_t len) {
+    if (stream_len + len > stream_size) {
+        stream_size = 2 * (stream_len + len);
+        stream = realloc(stream, stream_size);
+    }
+    memcpy(stream + stream_len, buf, len);
+    stream_len += len;
+}
+
+static void put_byte(uint8_t c) {
+    put(&c, 1);
+}
+
+// Valid frame i: TAG, i on 3 bytes, random bytes
+static uint8_t sent[FRAMES][PROTO_MAX_PAYLOAD + 1];     // len, payload
+
+static void put_frame(uint32_t i) {
+    uint8_t frame[PROTO_FRAME_MAX], payload[PROTO_MAX_PAYLOAD];
+    uint32_t len = 4 + test_rand() % (PROTO_MAX_PAYLOAD - 3);
+
+    payload[0] = TAG;
+    payload[1] = (uint8_t)i;
+    payload[2] = (uint8_t)(i >> 8);
+    payload[3] = (uint8_t)(i >> 16);
+    for (uint32_t k = 4; k < len; ++k) {
+        payload[k] = (uint8_t)test_rand();
+    }
+    sent[i][0] = (uint8_t)len;
+    memcpy(sent[i] + 1, payload, len);
+    put(frame, proto_frame(frame, PROTO_F_CMD, (uint8_t)i, payload, len));
+}
+
+// Noise: random bytes, false SYNC bytes followed by a plausible LEN, or a
+// frame with one byte changed or cut short
+static void put_noise(void) {
+    uint8_t frame[PROTO_FRAME_MAX], payload[PROTO_MAX_PAYLOAD];
+    uint32_t n = test_rand() % NOISE_MAX, len;
+
+    for (uint32_t k = 0; k < n; ++k) {
+        switch (test_rand() % 8) {
+        case 0:
+            put_byte(PROTO_SYNC);
+            break;
+        case 1:
+            put_byte(PROTO_SYNC);
+            put_byte((uint8_t)(test_rand() % (PROTO_MAX_PAYLOAD + 1)));
+            break;
+        default:
+            put_byte((uint8_t)test_rand());
+            break;
+        }
+    }
+    switch (test_rand() % 4) {
+    case 0:                             // corrupted
+        len = test_rand() % (PROTO_MAX_PAYLOAD + 1);
+        for (uint32_t k = 0; k < len; ++k) {
+            payload[k] = (uint8_t)test_rand();
+        }
+        len = proto_frame(frame, PROTO_F_CMD, 0, payload, len);
+        frame[1 + test_rand() % (len - 1)] ^= (uint8_t)(1 + test_rand() % 255);
+        put(frame, len);
+        break;
+    case 1:                             // truncated
+        len = proto_frame(frame, PROTO_F_CMD, 0, payload, test_rand() % 16);
+        put(frame, 1 + test_rand() % (len - 1));
+        break;
+    default:
+        break;
+    }
+}
+
+/****************************************************************************
+ *  parser output
+ ***************************************************************************/
+static uint32_t expected;       // next valid frame
+static uint32_t lost, changed, spurious, swallowed, errors;
+static int after_spurious;      // the last frame was noise
+
+static void on_frame(const ProtoFrame *f) {
+    uint32_t i;
+
+    if (f->type != PROTO_F_CMD || f->len < 4 || f->payload[0] != TAG) {
+        spurious++;             // noise that passed the CRC
+        after_spurious = 1;
+        return;
+    }
+    i = f->payload[1] | f->payload[2] << 8 | (uint32_t)f->payload[3] << 16;
+    if (i < expected || i >= FRAMES) {
+        spurious++;
+        after_spurious = 1;
+        return;
+    }
+    // frames missing right after a false frame were part of it: the CRC
+    // cannot tell, the host sends them again for want of a reply
+    if (after_spurious) {
+        swallowed += i - expected;
+    } else {
+        lost += i - expected;
+    }
+    after_spurious = 0;
+    expected = i + 1;
+    if (f->seq != (uint8_t)i || f->len != sent[i][0] ||
+        memcmp(f->payload, sent[i] + 1, f->len) != 0) {
+        changed++;
+    }
+}
+
+static void on_error(uint8_t seq, uint8_t error) {
+    (void)seq;
+    (void)error;
+    errors++;
+}
+
+// Feed stream[0..len[ in random chunks, each copied to a buffer of its
+// exact size
+static void feed(ProtoParser *p, const uint8_t *buf, uint32_t len) {
+    for (uint32_t i = 0; i < len; ) {
+        uint32_t n = 1 + test_rand() % 200;
+        uint8_t *chunk;
+
+        if (n > len - i) {
+            n = len - i;
+        }
+        chunk = malloc(n);
+        memcpy(chunk, buf + i, n);
+        proto_feed(p, chunk, n);
+        free(chunk);
+        i += n;
+    }
+}
+
+static void reset(ProtoParser *p) {
+    proto_init(p, on_frame, on_error);
+    stream_len = 0;
+    expected = lost = changed = spurious = swallowed = errors = 0;
+    after_spurious = 0;
+}
+
+// Enough non-SYNC bytes to end any frame the parser is in
+static void put_flush(void) {
+    for (int k = 0; k < PROTO_FRAME_MAX; ++k) {
+        put_byte(0);
+    }
+}
+
+/****************************************************************************
+ *  tests
+ ***************************************************************************/
+// A false SYNC and LEN right before a frame: the bytes of the frame are
+// first taken as the payload of the false one, and must be parsed again
+// once its CRC fails
+static void test_false_sync(void) {
+    static const uint8_t lens[] = { 0, 1, 5, 40, PROTO_MAX_PAYLOAD };
+    ProtoParser p;
+
+    for (uint32_t k = 0; k < sizeof(lens); ++k) {
+        reset(&p);
+        put_byte(PROTO_SYNC);
+        put_byte(lens[k]);
+        put_frame(0);
+        put_frame(1);
+        put_flush();
+        feed(&p, stream, stream_len);
+        CHECK(expected == 2 && lost == 0 && changed == 0);
+    }
+
+    // a false SYNC inside the CRC of a corrupted frame, a LEN over the
+    // maximum, and a SYNC repeated
+    reset(&p);
+    put_byte(PROTO_SYNC);
+    put_byte(PROTO_MAX_PAYLOAD + 1);
+    put_byte(PROTO_SYNC);
+    put_byte(PROTO_SYNC);
+    put_frame(0);
+    put_flush();
+    feed(&p, stream, stream_len);
+    CHECK(expected == 1 && lost == 0 && changed == 0);
+}
+
+static void test_fuzz(void) {
+    ProtoParser p;
+
+    reset(&p);
+    for (uint32_t i = 0; i < FRAMES; ++i) {
+        put_noise();
+        put_frame(i);
+    }
+    put_flush();
+    feed(&p, stream, stream_len);
+    lost += FRAMES - expected;
+
+    printf("proto_test: %u bytes, %u frames, %u lost, %u changed, "
+           "%u CRC errors, %u spurious (%u frames in them)\n", stream_len,
+           FRAMES, lost, changed, errors, spurious, swallowed);
+    CHECK(lost == 0);
+    CHECK(changed == 0);
+    CHECK(p.stats.frames == FRAMES - swallowed + spurious);
+}
+
+int main(void) {
+    test_false_sync();
+    test_fuzz();
+    printf("proto_test: %d checks, %d failed\n", checks, failures);
+    free(stream);
+    return failures != 0;
+}
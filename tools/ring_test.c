@@ -0,0 +1,232 @@
+/*
+ * ring_test : host tests of the SPSC byte ring (lib/ring.h): empty and
+ *             full rings, spans at the end of the buffer, partial
+ *             commits, counters wrapping around 2^32, and a long random
+ *             run against a plain queue, every byte checked.
+ *
+ * usage: ring_test (exit status 1 if a check fails)
+ */
+#include <stdio.h>
+#include <string.h>
+#include "lib/ring.h"
+
+#define SIZE        16
+#define RANDOM_OPS  200000
+
+static int checks, failures;
+
+#define CHECK(cond)     check((cond), #cond, __LINE__)
+
+static void check(int ok, const char *what, int line) {
+    checks++;
+    if (!ok) {
+        failures++;
+        printf("ring_test.c:%d: failed: %s\n", line, what);
+    }
+}
+
+static char data[SIZE];
+
+// Ring of SIZE bytes whose counters both start at 'start'
+static void ring_at(Ring *r, uint32_t start) {
+    ring_init(r, data, sizeof(data));
+    r->wr = r->rd = start;
+}
+
+static void test_empty_full(void) {
+    Ring r;
+    const char *rp;
+    char *wp;
+
+    ring_at(&r, 0);
+    CHECK(ring_count(&r) == 0);
+    CHECK(ring_space(&r) == SIZE);
+    CHECK(ring_pop(&r) == -1);
+    CHECK(ring_read_span(&r, &rp) == 0);
+
+    for (int i = 0; i < SIZE; ++i) {
+        CHECK(ring_push(&r, (char)(0xF0 + i)) == 0);
+    }
+    CHECK(ring_count(&r) == SIZE);
+    CHECK(ring_space(&r) == 0);
+    CHECK(ring_push(&r, 'x') == -1);
+    CHECK(ring_write_span(&r, &wp) == 0);
+    CHECK(ring_write(&r, "xy", 2) == 0);
+
+    for (int i = 0; i < SIZE; ++i) {
+        CHECK(ring_pop(&r) == 0xF0 + i);    // 0..255, not sign extended
+    }
+    CHECK(ring_pop(&r) == -1);
+    CHECK(ring_count(&r) == 0);
+}
+
+// Spans stop at the end of the buffer, the rest is at its start
+static void test_edge(void) {
+    Ring r;
+    const char *rp;
+    char *wp, out[8];
+
+    ring_at(&r, SIZE - 3);
+    CHECK(ring_write_span(&r, &wp) == 3);
+    CHECK(wp == data + SIZE - 3);
+    CHECK(ring_write(&r, "abcdefg", 7) == 7);
+    CHECK(memcmp(data + SIZE - 3, "abc", 3) == 0);
+    CHECK(memcmp(data, "defg", 4) == 0);
+
+    CHECK(ring_read_span(&r, &rp) == 3);
+    CHECK(rp == data + SIZE - 3);
+    ring_read_commit(&r, 3);
+    CHECK(ring_read_span(&r, &rp) == 4);
+    CHECK(rp == data);
+
+    // the free space left after the wrap is one span
+    CHECK(ring_write_span(&r, &wp) == SIZE - 4);
+    CHECK(wp == data + 4);
+
+    CHECK(ring_read(&r, out, sizeof(out)) == 4);
+    CHECK(memcmp(out, "defg", 4) == 0);
+}
+
+// Committing part of a span publishes or releases only that part
+static void test_partial(void) {
+    Ring r;
+    const char *rp;
+    char *wp;
+
+    ring_at(&r, 5);
+    CHECK(ring_write_span(&r, &wp) == SIZE - 5);
+    memcpy(wp, "12345", 5);
+    ring_write_commit(&r, 2);
+    CHECK(ring_count(&r) == 2);
+    CHECK(ring_write_span(&r, &wp) == SIZE - 7);
+    CHECK(wp == data + 7);
+    memcpy(wp, "XY", 2);                    // overwrites the uncommitted 345
+    ring_write_commit(&r, 2);
+
+    CHECK(ring_read_span(&r, &rp) == 4);
+    CHECK(memcmp(rp, "12XY", 4) == 0);
+    ring_read_commit(&r, 1);
+    CHECK(ring_count(&r) == 3);
+    CHECK(ring_read_span(&r, &rp) == 3);
+    CHECK(memcmp(rp, "2XY", 3) == 0);
+    ring_read_commit(&r, 0);
+    CHECK(ring_count(&r) == 3);
+    CHECK(ring_pop(&r) == '2');
+}
+
+// The free running counters overflow: count and space still hold
+static void test_wraparound(void) {
+    Ring r;
+    char out[SIZE];
+
+    ring_at(&r, 0xFFFFFFFFu - 5);
+    for (int i = 0; i < SIZE; ++i) {
+        CHECK(ring_push(&r, (char)('A' + i)) == 0);
+    }
+    CHECK(r.wr < r.rd);
+    CHECK(ring_count(&r) == SIZE);
+    CHECK(ring_space(&r) == 0);
+    CHECK(ring_push(&r, 'x') == -1);
+    CHECK(ring_read(&r, out, SIZE) == SIZE);
+    for (int i = 0; i < SIZE; ++i) {
+        CHECK(out[i] == 'A' + i);
+    }
+    CHECK(ring_count(&r) == 0);
+}
+
+/* Random operations, both counters starting below 2^32, checked against
+ * a plain queue: every byte read must be the next byte written.
+ */
+static uint32_t rand_state = 1;
+
+static uint32_t test_rand(void) {
+    rand_state ^= rand_state << 13;         // xorshift32
+    rand_state ^= rand_state >> 17;
+    rand_state ^= rand_state << 5;
+    return rand_state;
+}
+
+static void test_random(void) {
+    Ring r;
+    uint8_t next_in = 0, next_out = 0;      // byte values written, read
+    uint32_t count = 0, bad = 0, n, len;
+    const char *rp;
+    char *wp, buf[SIZE * 2];
+
+    ring_at(&r, 0xFFFFFFFFu - 1000);
+    for (int op = 0; op < RANDOM_OPS; ++op) {
+        switch (test_rand() % 6) {
+        case 0:                             // push
+            if (ring_push(&r, (char)next_in) == 0) {
+                next_in++;
+                count++;
+            } else {
+                bad += count != SIZE;
+            }
+            break;
+        case 1: {                           // pop
+            int c = ring_pop(&r);
+
+            if (c >= 0) {
+                bad += c != next_out++;
+                count--;
+            } else {
+                bad += count != 0;
+            }
+            break;
+        }
+        case 2:                             // write
+            len = test_rand() % sizeof(buf);
+            for (uint32_t i = 0; i < len; ++i) {
+                buf[i] = (char)(next_in + i);
+            }
+            n = ring_write(&r, buf, len);
+            bad += n != (len < SIZE - count ? len : SIZE - count);
+            next_in = (uint8_t)(next_in + n);
+            count += n;
+            break;
+        case 3:                             // read
+            len = test_rand() % sizeof(buf);
+            n = ring_read(&r, buf, len);
+            bad += n != (len < count ? len : count);
+            for (uint32_t i = 0; i < n; ++i) {
+                bad += (uint8_t)buf[i] != next_out++;
+            }
+            count -= n;
+            break;
+        case 4:                             // write span, partial commit
+            n = ring_write_span(&r, &wp);
+            bad += n > SIZE - count;
+            len = n ? test_rand() % (n + 1) : 0;
+            for (uint32_t i = 0; i < len; ++i) {
+                wp[i] = (char)next_in++;
+            }
+            ring_write_commit(&r, len);
+            count += len;
+            break;
+        default:                            // read span, partial commit
+            n = ring_read_span(&r, &rp);
+            bad += n > count || (count && !n);
+            len = n ? test_rand() % (n + 1) : 0;
+            for (uint32_t i = 0; i < len; ++i) {
+                bad += (uint8_t)rp[i] != next_out++;
+            }
+            ring_read_commit(&r, len);
+            count -= len;
+            break;
+        }
+        bad += ring_count(&r) != count || ring_space(&r) != SIZE - count;
+    }
+    CHECK(bad == 0);
+    CHECK(r.rd < 0xFFFFFFFFu - 1000);       // went past 2^32
+}
+
+int main(void) {
+    test_empty_full();
+    test_edge();
+    test_partial();
+    test_wraparound();
+    test_random();
+    printf("ring_test: %d checks, %d failed\n", checks, failures);
+    return failures != 0;
+}